@@ -30,7 +30,9 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/time.h>	// struct timeval
+#include <sys/uio.h>	// struct iovec
 
 #ifdef __cplusplus
 extern "C"
@@ -38,8 +40,13 @@ extern "C"
 #endif
 
 // configuration ----------------------------------------------------------------------------------
-#define MAX_MESSAGE_LENGTH	100000
-#define MAX_GROUP_SIZE		1000
+// upper bounds of the parser limits, see fix_parser_limits below
+#define MAX_MESSAGE_LENGTH	4000000
+#define MAX_GROUP_SIZE		100000
+#define MAX_GROUP_DEPTH		256
+
+// the largest tag accepted by set_fix_message_projection()
+#define MAX_PROJECTION_TAG	99999
 
 // gcc-specific attributes ------------------------------------------------------------------------
 #if defined __GNUC__ || defined __clang__
@@ -72,6 +79,7 @@ typedef struct fix_group fix_group;
 
 // FIX parser handle
 typedef struct fix_parser fix_parser;
+typedef struct fix_parser_spec fix_parser_spec;
 
 // parser error codes
 typedef enum
@@ -124,11 +132,37 @@ typedef struct
 // Parser control table structures ---------------------------------------------------------------
 typedef enum { TAG_STRING, TAG_LENGTH, TAG_BINARY, TAG_GROUP } tag_value_type;
 
+// tag lookup table: tag info for the tags below 'num_tags' is at 'tag_info[tag]', the other tags
+// are found via perfect hash 'hash_keys[(uint32_t)(tag * hash_mul) >> hash_shift]'; 0xFFFF means no tag.
+// An empty table (no arrays) means the tag info function is used instead.
+typedef struct
+{
+	const uint16_t* tag_info;
+	unsigned num_tags;
+	const uint32_t* hash_keys;
+	const uint16_t* hash_values;
+	uint32_t hash_mul;
+	unsigned hash_shift;
+} fix_tag_table;
+
+// tag value types, from the field types of the specification
+typedef enum
+{
+	FIX_VALUE_STRING,		// any type not listed below
+	FIX_VALUE_LONG,			// INT, SEQNUM, LENGTH, DAYOFMONTH
+	FIX_VALUE_DOUBLE,		// FLOAT, PRICE, QTY, AMT, PRICEOFFSET, PERCENTAGE
+	FIX_VALUE_CHAR,			// CHAR
+	FIX_VALUE_BOOLEAN,		// BOOLEAN
+	FIX_VALUE_UTC_TIMESTAMP	// UTCTIMESTAMP
+} fix_value_type;
+
 typedef struct fix_group_info
 {
 	unsigned node_size, first_tag;		// number of tags and the first tag in the group node
 	unsigned (*get_tag_info)(unsigned);	// tag info function
 	const struct fix_group_info* (*get_group_info)(unsigned);	// group function
+	const fix_tag_table* tag_table;		// tag lookup table, may be NULL
+	const unsigned char* value_types;	// fix_value_type of each tag in the node, by tag index, may be NULL
 } fix_group_info;
 
 // parser table function return type
@@ -143,18 +177,173 @@ typedef struct
 fix_parser* create_fix_parser(const fix_message_info* (*parser_table)(const fix_string),
 							  const fix_string fix_version);
 
+// memory allocator, with the semantics of the standard functions; 'ctx' is passed to every call
+typedef struct
+{
+	void* (*malloc)(void* ctx, size_t size);
+	void* (*realloc)(void* ctx, void* p, size_t size);
+	void (*free)(void* ctx, void* p);
+	void* ctx;
+} fix_allocator;
+
+// constructor with a user-defined allocator, or the standard one if 'allocator' is NULL
+fix_parser* create_fix_parser_ex(const fix_message_info* (*parser_table)(const fix_string),
+								 const fix_string fix_version,
+								 const fix_allocator* const allocator);
+
 // destructor
 void free_fix_parser(fix_parser* const parser);
 
+// compiled specification: the parser table and the FIX version, shared read-only by any number of parsers
+fix_parser_spec* create_fix_parser_spec(const fix_message_info* (*parser_table)(const fix_string),
+										const fix_string fix_version);
+void free_fix_parser_spec(fix_parser_spec* const spec);
+
+// constructor of a parser sharing the given specification, which must outlive the parser
+fix_parser* create_fix_parser_from_spec(const fix_parser_spec* const spec, const fix_allocator* const allocator);
+
+// reset to the state of a new parser, keeping the settings and the memory allocated
+void reset_fix_parser(fix_parser* const parser);
+
+// parser flags
+typedef enum
+{
+	FIX_ZERO_COPY = 1,	// parse complete messages in place, without copying them out of the input buffer
+	FIX_RESYNC = 2,		// skip malformed input up to the next begin string instead of failing
+	FIX_LAZY = 4,			// parse the message body on the first access to each tag
+	FIX_EAGER_CONVERSION = 8,	// convert the long, double and utc_timestamp values while parsing
+	FIX_LINE_BREAKS = 16	// skip line breaks between messages, as in the line-based logs
+} fix_parser_flag;
+
+unsigned get_fix_parser_flags(const fix_parser* const parser) PURE_FUNC;
+void set_fix_parser_flags(fix_parser* const parser, unsigned flags);
+
+// SIMD kernels for checksum, copy and SOH search, selected at run-time
+typedef enum
+{
+	FIX_SIMD_AUTO,		// the best level supported by the CPU
+	FIX_SIMD_NONE,		// scalar code only
+	FIX_SIMD_SSE2,
+	FIX_SIMD_AVX2,
+	FIX_SIMD_AVX512		// AVX-512BW
+} fix_simd_level;
+
+fix_simd_level get_fix_parser_simd_level(const fix_parser* const parser) PURE_FUNC;
+bool set_fix_parser_simd_level(fix_parser* const parser, fix_simd_level level);
+
+// checksum verification policy
+typedef enum
+{
+	FIX_CHECKSUM_ALWAYS,	// verify every message (default)
+	FIX_CHECKSUM_NEVER,		// do not verify
+	FIX_CHECKSUM_SAMPLED,	// verify one message in N
+	FIX_CHECKSUM_DEFERRED	// verify on request only, via verify_fix_message_checksum() or validate_fix_message()
+} fix_checksum_policy;
+
+fix_checksum_policy get_fix_parser_checksum_policy(const fix_parser* const parser) PURE_FUNC;
+bool set_fix_parser_checksum_policy(fix_parser* const parser, fix_checksum_policy policy, unsigned sample_rate);
+
+// validation level
+typedef enum
+{
+	FIX_VALIDATION_STRICT,		// all checks (default)
+	FIX_VALIDATION_STRUCTURAL,	// framing and checksum only, no duplicate, tag order, group count or unknown tag checks
+	FIX_VALIDATION_NONE			// as above, and no checksum verification
+} fix_validation_level;
+
+fix_validation_level get_fix_parser_validation_level(const fix_parser* const parser) PURE_FUNC;
+bool set_fix_parser_validation_level(fix_parser* const parser, fix_validation_level level);
+
+// per-parser limits
+typedef struct
+{
+	unsigned max_message_length;	// BodyLength, 100000 by default; longer messages are framing errors
+	unsigned max_group_size;		// number of nodes in a repeating group, 1000 by default (FE_INVALID_VALUE)
+	unsigned max_group_depth;		// nesting depth of repeating groups, 16 by default (FE_OTHER)
+	unsigned max_tags;				// number of tags in a message, 0 (default) for no limit (FE_OTHER)
+} fix_parser_limits;
+
+fix_parser_limits get_fix_parser_limits(const fix_parser* const parser) PURE_FUNC;
+bool set_fix_parser_limits(fix_parser* const parser, const fix_parser_limits* const limits);
+
+// tag projection: only the listed tags and groups of the given message type are stored, the rest is skipped
+bool set_fix_message_projection(fix_parser* const parser, int msg_type_code, const unsigned* tags, unsigned num_tags);
+
 // message iteration
 const fix_parser_result* get_first_fix_message(fix_parser* const parser, const void* bytes, unsigned num_bytes);
 const fix_parser_result* get_next_fix_message(fix_parser* const parser);
 
+// message iteration over scattered input, e.g. the two segments of a ring buffer
+const fix_parser_result* get_first_fix_message_iov(fix_parser* const parser, const struct iovec* iov, unsigned iov_count);
+
+// batch message iteration: up to 'max_results' messages per call, all valid until the batch is released
+unsigned get_first_fix_message_batch(fix_parser* const parser, const void* bytes, unsigned num_bytes,
+									 const fix_parser_result** const results, unsigned max_results);
+unsigned get_next_fix_message_batch(fix_parser* const parser, const fix_parser_result** const results, unsigned max_results);
+void release_fix_message_batch(fix_parser* const parser);
+
+// two-stage pipeline, with the parser running on a separate thread and invoking the handler on each message
+typedef struct fix_pipeline fix_pipeline;
+typedef void (*fix_message_handler)(const fix_parser_result* const result, void* ctx);
+
+fix_pipeline* create_fix_pipeline(fix_parser* const framer, fix_parser* const parser, size_t ring_size,
+								  fix_message_handler handler, void* ctx);
+bool push_fix_pipeline_input(fix_pipeline* const pipeline, const void* bytes, unsigned num_bytes);
+fix_error close_fix_pipeline(fix_pipeline* const pipeline);
+
+// parallel log parser: the input is split into chunks at the begin strings of the messages, and the chunks
+// are parsed by a pool of threads, each with its own parser of the given specification
+typedef struct
+{
+	unsigned num_threads;	// number of threads, including the calling one; 0 for the number of cores
+	size_t chunk_size;		// approximate chunk size in bytes, 0 for the default (256KB)
+	unsigned flags;			// parser flags, FIX_ZERO_COPY is always set
+	bool ordered;			// deliver the messages in the input order, one at a time, otherwise concurrently
+} fix_log_options;
+
+fix_error parse_fix_log(const fix_parser_spec* const spec, const void* bytes, size_t num_bytes,
+						const fix_log_options* const options, fix_message_handler handler, void* ctx);
+fix_error parse_fix_log_file(const fix_parser_spec* const spec, const char* const file_name,
+							 const fix_log_options* const options, fix_message_handler handler, void* ctx);
+
+// message framing
+typedef struct
+{
+	unsigned offset, length;	// message location in the input buffer
+	bool checksum_ok;			// checksum validation result
+} fix_frame;
+
+typedef struct
+{
+	fix_frame* frames;			// frame array, provided by the caller
+	unsigned max_frames;		// capacity of the frame array
+	unsigned num_frames;		// number of frames found
+	unsigned tail;				// offset of the first byte not covered by any frame
+} fix_frame_index;
+
+fix_error build_fix_frame_index(const fix_parser* const parser, const void* bytes, unsigned num_bytes,
+								fix_frame_index* const index);
+const fix_parser_result* get_fix_message_from_frame(fix_parser* const parser, const void* bytes,
+													const fix_frame* const frame);
+
 // parser error
 const fix_error_details* get_fix_parser_error_details(const fix_parser* const parser) PURE_FUNC;
 
+// parser statistics
+typedef struct
+{
+	unsigned long discarded_bytes;	// number of bytes skipped while resynchronising
+	unsigned long num_resyncs;		// number of times the synchronisation with the input was lost
+	unsigned long group_allocs;		// number of heap allocations for message groups
+	unsigned long group_memory;		// number of bytes held for message groups
+} fix_parser_stats;
+
+const fix_parser_stats* get_fix_parser_stats(const fix_parser* const parser) PURE_FUNC;
+
 // helpers
 fix_string get_raw_fix_message(const fix_parser* const parser) PURE_FUNC;
+fix_error verify_fix_message_checksum(const fix_parser* const parser) PURE_FUNC;
+fix_error validate_fix_message(fix_parser* const parser);
 
 // FIX group -------------------------------------------------------------------------------------
 // group node iterator
@@ -232,6 +421,26 @@ typedef enum
 
 fix_error get_fix_tag_as_fix_version(const fix_group* const group, unsigned tag, fix_version* const result);
 
+// tag as enumerated value: the ordinal of the value in its field's value list from the specification;
+// a value not in the list is reported as FE_INVALID_VALUE.
+// Single-character values are looked up in a bitset of their codes, with the ordinals at 'ordinals[rank of the bit]';
+// the other values are found via perfect hash 'slots[(hash * hash_mul) >> hash_shift]', holding the ordinal plus one,
+// and compared to 'values[ordinal]'. The sets are generated by the specification compiler.
+typedef struct
+{
+	uint64_t chars[2];				// bitset of the single-character values
+	const unsigned char* ordinals;	// ordinals of the single-character values, by bit rank
+	const unsigned char* slots;		// hash table of the other values, NULL for the single-character sets
+	const char* const* values;		// the other values, by ordinal
+	uint64_t hash_mul;
+	unsigned hash_shift;
+} fix_enum_set;
+
+fix_error get_fix_tag_as_enum(const fix_group* const group, unsigned tag, const fix_enum_set* const set, int* const result);
+
+// ordinal of the value in the set, or -1 if the value is not in the set
+int get_fix_enum_ordinal(const fix_enum_set* const set, const fix_string value) PURE_FUNC;
+
 // generic get_fix_tag()
 // supported from gcc 4.9 only :(
 #if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
@@ -246,6 +455,36 @@ fix_error get_fix_tag_as_fix_version(const fix_group* const group, unsigned tag,
 	)((g), (t), (p))
 #endif
 
+// generated decoders support ---------------------------------------------------------------------
+// string values of all the tags of the given node, by their positions in the specification, with
+// empty strings for the tags not present and for the groups; 'values' must hold the whole node
+fix_error get_fix_node_values(const fix_group* const group, unsigned node, fix_string* const values);
+
+// group at the given position of the node, or NULL if not present
+fix_group* get_fix_node_group(const fix_group* const group, unsigned node, unsigned index) PURE_FUNC;
+
+// error details of the group, for the errors found by the decoders
+fix_error set_fix_group_error(const fix_group* const group, fix_error err, unsigned tag, const fix_string context);
+
+// tag value converters, with the same rules as the get_fix_tag_as_*() functions above;
+// the long and double converters read up to the first non-digit, so their value must be
+// a non-empty tag value from a message, while the others take any string
+fix_error convert_fix_value_to_long(const fix_string value, long* const result);
+fix_error convert_fix_value_to_double(const fix_string value, double* const result);
+fix_error convert_fix_value_to_char(const fix_string value, char* const result);
+fix_error convert_fix_value_to_boolean(const fix_string value, bool* const result);
+fix_error convert_fix_value_to_utc_timestamp(const fix_string value, utc_timestamp* const result);
+fix_error convert_fix_value_to_tz_timestamp(const fix_string value, tz_timestamp* const result);
+fix_error convert_fix_value_to_LocalMktDate(const fix_string value, utc_timestamp* const result);
+fix_error convert_fix_value_to_fix_version(const fix_string value, fix_version* const result);
+
+// memory for the repeating groups of a decoded message, provided by the caller and reused for every message
+typedef struct
+{
+	void* memory;		// aligned as by malloc()
+	size_t size, used;
+} fix_decoder_arena;
+
 // utilities -------------------------------------------------------------------------------------
 // utc_timestamp to struct timeval converter
 fix_error utc_timestamp_to_timeval(const utc_timestamp* const utc, struct timeval* const result);
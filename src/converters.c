@@ -29,6 +29,7 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "fix_impl.h"
 #include <math.h>
 #include <errno.h>
+#include <string.h>
 
 #define RETURN(r)	return group->error->code = (r)
 
@@ -44,7 +45,7 @@ fix_error copy_fix_tag_as_string(const fix_group* const group, unsigned tag, cha
 	if(result)
 	{
 		const size_t n = fix_string_length(value);
-		char* const p = *result = malloc(n + 1);
+		char* const p = *result = ALLOC(group->allocator, n + 1);
 
 		if(!p)
 			RETURN( FE_OUT_OF_MEMORY );
@@ -101,22 +102,16 @@ const char* convert_digits(const char* s, long* const result)
 	return convert_significant_digits(skip_zeroes(s), result);
 }
 
-// tag as long integer
-fix_error get_fix_tag_as_long(const fix_group* const group, unsigned tag, long* const result)
+// tag value as long integer
+fix_error convert_fix_value_to_long(fix_string value, long* const result)
 {
 	/* From the spec:
 	 *		Sequence of digits without commas or decimals and optional sign character (ASCII characters "-" and "0" - "9" ).
 	 *		The sign character utilizes one byte (i.e. positive int is "99999" while negative int is "-99999").
 	 *		Note that int values may contain leading zeros (e.g. "00023" = "23"). */
 
-	fix_string value;
-	const fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
-
 	if(fix_string_length(value) > 20)	// ???
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// sign
 	bool neg = false;
@@ -133,10 +128,10 @@ fix_error get_fix_tag_as_long(const fix_group* const group, unsigned tag, long*
 
 	// validation
 	if(!s || s == value.begin || (neg && val == 0))	// overflow, no digits or '-0'
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	if(s < value.end)				// unprocessed bytes
-		RETURN( FE_INCORRECT_VALUE_FORMAT );
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	// all clear
 	if(result)
@@ -145,8 +140,8 @@ fix_error get_fix_tag_as_long(const fix_group* const group, unsigned tag, long*
 	return FE_OK;
 }
 
-// tag as double
-fix_error get_fix_tag_as_double(const fix_group* const group, unsigned tag, double* const result)
+// tag value as double
+fix_error convert_fix_value_to_double(fix_string value, double* const result)
 {
 	/* From the spec:
 	 *		Sequence of digits with optional decimal point and sign character (ASCII characters "-", "0" - "9" and ".");
@@ -158,12 +153,6 @@ fix_error get_fix_tag_as_double(const fix_group* const group, unsigned tag, doub
 
 	// About significant digits: https://en.wikipedia.org/wiki/Significant_figures
 
-	fix_string value;
-	const fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
-
 	// sign
 	bool neg = false;
 
@@ -185,12 +174,12 @@ fix_error get_fix_tag_as_double(const fix_group* const group, unsigned tag, doub
 	s = convert_significant_digits(s, &int_part);
 
 	if(!s)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	unsigned nsig = s - value.begin;	// significant digits counter
 
 	if(nsig > 15)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	long frac_part = 0;
 	unsigned nfrac = 0;
@@ -202,20 +191,20 @@ fix_error get_fix_tag_as_double(const fix_group* const group, unsigned tag, doub
 		s = convert_digits(s, &frac_part);
 
 		if(!s)
-			RETURN( FE_INCORRECT_VALUE_FORMAT );
+			return FE_INCORRECT_VALUE_FORMAT;
 
 		nfrac = s - value.begin;
 
 		if(nsig + nfrac > 15)	// counting trailing zeros as significant, contrary to the definition
-			RETURN( FE_INCORRECT_VALUE_FORMAT );
+			return FE_INCORRECT_VALUE_FORMAT;
 	}
 
 	// final checks
 	if(s < value.end || (nzero + nsig + nfrac == 0))	// unprocessed bytes or no digits
-		RETURN( FE_INCORRECT_VALUE_FORMAT );
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	if(neg && int_part == 0 && frac_part == 0)	// -0.0
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// compose result
 	static const double factor[] = { 0., 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9, 1e-10, 1e-11, 1e-12, 1e-13, 1e-14, 1e-15 };
@@ -235,17 +224,11 @@ fix_error get_fix_tag_as_double(const fix_group* const group, unsigned tag, doub
 	return FE_OK;
 }
 
-// tag as single char
-fix_error get_fix_tag_as_char(const fix_group* const group, unsigned tag, char* const result)
+// tag value as single char
+fix_error convert_fix_value_to_char(const fix_string value, char* const result)
 {
-	fix_string value;
-	const fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
-
 	if(fix_string_length(value) != 1)
-		RETURN( FE_INCORRECT_VALUE_FORMAT );
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	if(result)
 		*result = *value.begin;
@@ -253,11 +236,11 @@ fix_error get_fix_tag_as_char(const fix_group* const group, unsigned tag, char*
 	return FE_OK;
 }
 
-// tag as boolean
-fix_error get_fix_tag_as_boolean(const fix_group* const group, unsigned tag, bool* const result)
+// tag value as boolean
+fix_error convert_fix_value_to_boolean(const fix_string value, bool* const result)
 {
-	char value;
-	const fix_error err = get_fix_tag_as_char(group, tag, &value);
+	char c;
+	const fix_error err = convert_fix_value_to_char(value, &c);
 
 	if(err != FE_OK)
 		return err;
@@ -265,7 +248,7 @@ fix_error get_fix_tag_as_boolean(const fix_group* const group, unsigned tag, boo
 	// conversion
 	bool r;
 
-	switch(value)
+	switch(c)
 	{
 		case 'Y':
 			r = true;
@@ -274,7 +257,7 @@ fix_error get_fix_tag_as_boolean(const fix_group* const group, unsigned tag, boo
 			r = false;
 			break;
 		default:
-			RETURN( FE_INCORRECT_VALUE_FORMAT );
+			return FE_INCORRECT_VALUE_FORMAT;
 	}
 
 	if(result)
@@ -283,18 +266,71 @@ fix_error get_fix_tag_as_boolean(const fix_group* const group, unsigned tag, boo
 	return FE_OK;
 }
 
+// tag accessors: the conversion error is recorded in the group error details
+#define CONVERT_TAG(convert)	\
+	fix_string value;	\
+	fix_error err = get_fix_tag_as_string(group, tag, &value);	\
+	\
+	if(err == FE_OK && (err = convert(value, result)) != FE_OK)	\
+		group->error->code = err;	\
+	\
+	return err
+
+// the same for the types converted while parsing in eager conversion mode, where the value is just loaded
+#define LOAD_OR_CONVERT_TAG(type, convert, load)	\
+	fix_string value;	\
+	const converted_value* cv;	\
+	fix_error err = get_tag_value(group, tag, (type), &value, &cv);	\
+	\
+	if(err == FE_OK)	\
+	{	\
+		if(cv)	\
+		{	\
+			if(result)	\
+				load;	\
+		}	\
+		else if((err = convert(value, result)) != FE_OK)	\
+			group->error->code = err;	\
+	}	\
+	\
+	return err
+
+// tag as long integer
+fix_error get_fix_tag_as_long(const fix_group* const group, unsigned tag, long* const result)
+{
+	LOAD_OR_CONVERT_TAG(FIX_VALUE_LONG, convert_fix_value_to_long, *result = cv->l);
+}
+
+// tag as double
+fix_error get_fix_tag_as_double(const fix_group* const group, unsigned tag, double* const result)
+{
+	LOAD_OR_CONVERT_TAG(FIX_VALUE_DOUBLE, convert_fix_value_to_double, *result = cv->d);
+}
+
+// tag as single char
+fix_error get_fix_tag_as_char(const fix_group* const group, unsigned tag, char* const result)
+{
+	CONVERT_TAG(convert_fix_value_to_char);
+}
+
+// tag as boolean
+fix_error get_fix_tag_as_boolean(const fix_group* const group, unsigned tag, bool* const result)
+{
+	CONVERT_TAG(convert_fix_value_to_boolean);
+}
+
 // matchers (unsafe macros!)
 #define READ_FIRST_DIGIT(s, r)	\
 	switch(*(s)) {	\
 		case '0' ... '9': (r) = *(s) - '0'; break;	\
-		default: RETURN( FE_INCORRECT_VALUE_FORMAT );	\
+		default: return FE_INCORRECT_VALUE_FORMAT;	\
 	}	\
 	++(s)
 
 #define READ_DIGIT(s, r)	\
 	switch(*(s)) {	\
 		case '0' ... '9': (r) = (r) * 10 + *(s) - '0'; break;	\
-		default: RETURN( FE_INCORRECT_VALUE_FORMAT );	\
+		default: return FE_INCORRECT_VALUE_FORMAT;	\
 	}	\
 	++(s)
 
@@ -302,11 +338,11 @@ fix_error get_fix_tag_as_boolean(const fix_group* const group, unsigned tag, boo
 #define READ_3_DIGITS(s, r)	READ_FIRST_DIGIT((s), (r)); READ_DIGIT((s), (r)); READ_DIGIT((s), (r))
 #define READ_4_DIGITS(s, r)	READ_FIRST_DIGIT((s), (r)); READ_DIGIT((s), (r)); READ_DIGIT((s), (r)); READ_DIGIT((s), (r))
 
-#define MATCH(s, c)	if(CHAR_TO_INT(*(s)++) != (c)) { RETURN( FE_INCORRECT_VALUE_FORMAT ); } else ((void)0)
+#define MATCH(s, c)	if(CHAR_TO_INT(*(s)++) != (c)) { return FE_INCORRECT_VALUE_FORMAT; } else ((void)0)
 
 // helper to read the 'YYYYMMDD' part of the time-stamp
 static
-fix_error read_date_part(const fix_group* const group, fix_string* const ps, utc_timestamp* const ts)
+fix_error read_date_part(fix_string* const ps, utc_timestamp* const ts)
 {
 	// format 'YYYYMMDD', where YYYY = 0000-9999, MM = 01-12, DD = 01-31
 	const char* s = ps->begin;
@@ -318,13 +354,13 @@ fix_error read_date_part(const fix_group* const group, fix_string* const ps, utc
 	READ_2_DIGITS(s, ts->month);
 
 	if(ts->month == 0 || ts->month > 12)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// day
 	READ_2_DIGITS(s, ts->day);
 
 	if(ts->day == 0 || ts->day > 31)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// all done
 	ps->begin = s;
@@ -333,7 +369,7 @@ fix_error read_date_part(const fix_group* const group, fix_string* const ps, utc
 
 // helper to read 'HH:MM:SS' part of the time-stamp
 static
-fix_error read_time_part(const fix_group* const group, fix_string* const ps, utc_timestamp* const ts)
+fix_error read_time_part(fix_string* const ps, utc_timestamp* const ts)
 {
 	// format 'HH:MM:SS.sss', where HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second).
 	const char* s = ps->begin;
@@ -341,21 +377,21 @@ fix_error read_time_part(const fix_group* const group, fix_string* const ps, utc
 	READ_2_DIGITS(s, ts->hour);
 
 	if(ts->hour > 23)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// minute
 	MATCH(s, ':');
 	READ_2_DIGITS(s, ts->minute);
 
 	if(ts->minute > 59)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// second
 	MATCH(s, ':');
 	READ_2_DIGITS(s, ts->second);
 
 	if(ts->second > 60)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// all done
 	ps->begin = s;
@@ -364,9 +400,9 @@ fix_error read_time_part(const fix_group* const group, fix_string* const ps, utc
 
 // helper to read 'HH:MM:SS.sss' part of the time-stamp
 static
-fix_error read_time_ms_part(const fix_group* const group, fix_string* const ps, utc_timestamp* const ts)
+fix_error read_time_ms_part(fix_string* const ps, utc_timestamp* const ts)
 {
-	const fix_error err = read_time_part(group, ps, ts);
+	const fix_error err = read_time_part(ps, ts);
 
 	if(err != FE_OK)
 		return err;
@@ -374,7 +410,7 @@ fix_error read_time_ms_part(const fix_group* const group, fix_string* const ps,
 	// milliseconds, if any
 	const char* s = ps->begin;
 
-	if(*s == '.')
+	if(ps->end - s >= 4 && *s == '.')
 	{
 		++s;
 		READ_3_DIGITS(s, ts->millisecond);
@@ -389,15 +425,15 @@ fix_error read_time_ms_part(const fix_group* const group, fix_string* const ps,
 
 // helper to read both date and time parts of the time-stamp string
 static
-fix_error read_timestamp_part(const fix_group* const group, fix_string* const ps, utc_timestamp* const ts)
+fix_error read_timestamp_part(fix_string* const ps, utc_timestamp* const ts)
 {
-	fix_error err = read_date_part(group, ps, ts);
+	fix_error err = read_date_part(ps, ts);
 
 	if(err != FE_OK)
 		return err;
 
 	MATCH(ps->begin, '-');
-	err = read_time_ms_part(group, ps, ts);
+	err = read_time_ms_part(ps, ts);
 
 	if(err != FE_OK)
 		return err;
@@ -405,8 +441,8 @@ fix_error read_timestamp_part(const fix_group* const group, fix_string* const ps
 	return FE_OK;
 }
 
-// tag as utc_timestamp
-fix_error get_fix_tag_as_utc_timestamp(const fix_group* const group, unsigned tag, utc_timestamp* const result)
+// tag value as utc_timestamp
+fix_error convert_fix_value_to_utc_timestamp(fix_string value, utc_timestamp* const result)
 {
 	// from the spec:
 	// 	string field representing Time/date combination represented in UTC (Universal Time Coordinated, also known as "GMT")
@@ -415,20 +451,17 @@ fix_error get_fix_tag_as_utc_timestamp(const fix_group* const group, unsigned ta
 	// 	* YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second) (without milliseconds).
 	// 	* YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second), sss=000-999 (indicating milliseconds).
 
-	fix_string value;
-	fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
+	if(fix_string_length(value) < sizeof("YYYYMMDD-HH:MM:SS") - 1)
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	utc_timestamp ts;
-
-	err = read_timestamp_part(group, &value, &ts);
+	const fix_error err = read_timestamp_part(&value, &ts);
 
 	if(err != FE_OK)
 		return err;
 
-	MATCH(value.begin, SOH);
+	if(value.begin != value.end)
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	// all done
 	if(result)
@@ -437,8 +470,8 @@ fix_error get_fix_tag_as_utc_timestamp(const fix_group* const group, unsigned ta
 	return FE_OK;
 }
 
-// tag as tz_timestamp
-fix_error get_fix_tag_as_tz_timestamp(const fix_group* const group, unsigned tag, tz_timestamp* const result)
+// tag value as tz_timestamp
+fix_error convert_fix_value_to_tz_timestamp(fix_string value, tz_timestamp* const result)
 {
 	// from the spec:
 	// string field representing a time/date combination representing local time with an offset to UTC to allow
@@ -446,23 +479,20 @@ fix_error get_fix_tag_as_tz_timestamp(const fix_group* const group, unsigned tag
 	// Format is YYYYMMDD-HH:MM:SS[Z | [ + | - hh[:mm]]]
 	// where YYYY = 0000 to 9999, MM = 01-12, DD = 01-31 HH = 00-23 hours, MM = 00-59 minutes, SS = 00-59 seconds,
 	//	hh = 01-12 offset hours, mm = 00-59 offset minutes
-	fix_string value;
-	fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
+	if(fix_string_length(value) < sizeof("YYYYMMDD-HH:MM:SS") - 1)
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	tz_timestamp ts;
 
 	// date
-	err = read_date_part(group, &value, &ts.utc);
+	fix_error err = read_date_part(&value, &ts.utc);
 
 	if(err != FE_OK)
 		return err;
 
 	// time
 	MATCH(value.begin, '-');
-	err = read_time_part(group, &value, &ts.utc);
+	err = read_time_part(&value, &ts.utc);
 
 	if(err != FE_OK)
 		return err;
@@ -470,12 +500,11 @@ fix_error get_fix_tag_as_tz_timestamp(const fix_group* const group, unsigned tag
 	// time zone offset
 	int sign = 1;
 
-	switch(*value.begin++)
+	if(value.begin == value.end)
+		ts.offset_minutes = 0;
+	else switch(*value.begin++)
 	{
 		case 'Z':
-			MATCH(value.begin, SOH);
-			// fall through
-		case SOH:
 			ts.offset_minutes = 0;
 			break;
 		case '-':
@@ -483,30 +512,35 @@ fix_error get_fix_tag_as_tz_timestamp(const fix_group* const group, unsigned tag
 			// fall through
 		case '+':
 		{
+			if(value.end - value.begin != sizeof("hh:mm") - 1)
+				return FE_INCORRECT_VALUE_FORMAT;
+
 			int hour, minute;
 
 			// hour
 			READ_2_DIGITS(value.begin, hour);
 
 			if(hour < 1 || hour > 12)
-				RETURN( FE_INVALID_VALUE );
+				return FE_INVALID_VALUE;
 
 			// minute
 			MATCH(value.begin, ':');
 			READ_2_DIGITS(value.begin, minute);
 
 			if(minute > 59)
-				RETURN( FE_INVALID_VALUE );
+				return FE_INVALID_VALUE;
 
 			// done
 			ts.offset_minutes = sign * (hour * 60 + minute);
-			MATCH(value.begin, SOH);
 			break;
 		}
 		default:
-			RETURN( FE_INCORRECT_VALUE_FORMAT );
+			return FE_INCORRECT_VALUE_FORMAT;
 	}
 
+	if(value.begin != value.end)
+		return FE_INCORRECT_VALUE_FORMAT;
+
 	// all done
 	if(result)
 		*result = ts;
@@ -514,8 +548,8 @@ fix_error get_fix_tag_as_tz_timestamp(const fix_group* const group, unsigned tag
 	return FE_OK;
 }
 
-// tag as LocalMktDate
-fix_error get_fix_tag_as_LocalMktDate(const fix_group* const group, unsigned tag, utc_timestamp* const result)
+// tag value as LocalMktDate
+fix_error convert_fix_value_to_LocalMktDate(fix_string value, utc_timestamp* const result)
 {
 	// from the spec (FIX.5.0SP2_EP194):
 	// string field representing a Date of Local Market (as oppose to UTC) in YYYYMMDD format.
@@ -528,11 +562,8 @@ fix_error get_fix_tag_as_LocalMktDate(const fix_group* const group, unsigned tag
 	// IT LOOKS LIKE MANY IMPLEMENTATIONS ACTUALLY USE THE FORMAT WITH DASHES, SO THIS
 	// FUNCTION EXPECTS A STRING IN THE "YYYY-MM-DD" FORMAT.
 
-	fix_string value;
-	const fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
+	if(fix_string_length(value) != sizeof("YYYY-MM-DD") - 1)
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	unsigned short year;
 	unsigned char month, day;
@@ -545,16 +576,17 @@ fix_error get_fix_tag_as_LocalMktDate(const fix_group* const group, unsigned tag
 	READ_2_DIGITS(value.begin, month);
 
 	if(month == 0 || month > 12)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
 	// day
 	MATCH(value.begin, '-');
 	READ_2_DIGITS(value.begin, day);
 
 	if(day == 0 || day > 31)
-		RETURN( FE_INVALID_VALUE );
+		return FE_INVALID_VALUE;
 
-	MATCH(value.begin, SOH);
+	if(value.begin != value.end)
+		return FE_INCORRECT_VALUE_FORMAT;
 
 	// all done
 	if(result)
@@ -567,17 +599,14 @@ fix_error get_fix_tag_as_LocalMktDate(const fix_group* const group, unsigned tag
 	return FE_OK;
 }
 
-// tag as FIX version
 #define CODE(a, b, c)	(CHAR_TO_INT(a) + (CHAR_TO_INT(b) << 8) + (CHAR_TO_INT(c) << 16))
 
-fix_error get_fix_tag_as_fix_version(const fix_group* const group, unsigned tag, fix_version* const result)
-{
-	fix_string value;
-	const fix_error err = get_fix_tag_as_string(group, tag, &value);
-
-	if(err != FE_OK)
-		return err;
+// character of the value at the given position, or 0 at the end of the value
+#define AT(p)	((p) < value.end ? *(p) : 0)
 
+// tag value as FIX version
+fix_error convert_fix_value_to_fix_version(const fix_string value, fix_version* const result)
+{
 	// conversion
 	switch(fix_string_length(value))
 	{
@@ -588,32 +617,32 @@ fix_error get_fix_tag_as_fix_version(const fix_group* const group, unsigned tag,
 				break;
 			// fall through
 		default:
-			RETURN( FE_INCORRECT_VALUE_FORMAT );
+			return FE_INCORRECT_VALUE_FORMAT;
 	}
 
 	fix_version ver;
 	const char* s = value.begin + 3;	// "FIX"
 
-	switch(CODE(s[0], s[1], s[2]))
+	switch(CODE(s[0], s[1], AT(s + 2)))
 	{
-		case CODE('2', '7', SOH): ver = FIX27; break;
-		case CODE('3', '0', SOH): ver = FIX30; break;
-		case CODE('4', '0', SOH): ver = FIX40; break;
-		case CODE('4', '1', SOH): ver = FIX41; break;
-		case CODE('4', '2', SOH): ver = FIX42; break;
-		case CODE('4', '3', SOH): ver = FIX43; break;
-		case CODE('4', '4', SOH): ver = FIX44; break;
-		case CODE('5', '0', SOH): ver = FIX50; break;
+		case CODE('2', '7', 0): ver = FIX27; break;
+		case CODE('3', '0', 0): ver = FIX30; break;
+		case CODE('4', '0', 0): ver = FIX40; break;
+		case CODE('4', '1', 0): ver = FIX41; break;
+		case CODE('4', '2', 0): ver = FIX42; break;
+		case CODE('4', '3', 0): ver = FIX43; break;
+		case CODE('4', '4', 0): ver = FIX44; break;
+		case CODE('5', '0', 0): ver = FIX50; break;
 		case CODE('5', '0', 'S'):
-			switch(CODE(s[3], s[4], s[5]))
+			switch(CODE(s[3], s[4], AT(s + 5)))
 			{
-				case CODE('P', '1', SOH): ver = FIX50SP1; break;
-				case CODE('P', '2', SOH): ver = FIX50SP2; break;
-				default: RETURN( FE_INCORRECT_VALUE_FORMAT );
+				case CODE('P', '1', 0): ver = FIX50SP1; break;
+				case CODE('P', '2', 0): ver = FIX50SP2; break;
+				default: return FE_INCORRECT_VALUE_FORMAT;
 			}
 			break;
 		default:
-			RETURN( FE_INCORRECT_VALUE_FORMAT );
+			return FE_INCORRECT_VALUE_FORMAT;
 	}
 
 	// store result
@@ -625,6 +654,90 @@ fix_error get_fix_tag_as_fix_version(const fix_group* const group, unsigned tag,
 }
 
 #undef CODE
+#undef AT
+
+// tag accessors
+static
+void unpack_timestamp(const packed_timestamp* const ts, utc_timestamp* const result)
+{
+	*result = (utc_timestamp){ ts->year, ts->month, ts->day, ts->hour, ts->minute, ts->second, ts->millisecond };
+}
+
+fix_error get_fix_tag_as_utc_timestamp(const fix_group* const group, unsigned tag, utc_timestamp* const result)
+{
+	LOAD_OR_CONVERT_TAG(FIX_VALUE_UTC_TIMESTAMP, convert_fix_value_to_utc_timestamp, unpack_timestamp(&cv->ts, result));
+}
+
+fix_error get_fix_tag_as_tz_timestamp(const fix_group* const group, unsigned tag, tz_timestamp* const result)
+{
+	CONVERT_TAG(convert_fix_value_to_tz_timestamp);
+}
+
+fix_error get_fix_tag_as_LocalMktDate(const fix_group* const group, unsigned tag, utc_timestamp* const result)
+{
+	CONVERT_TAG(convert_fix_value_to_LocalMktDate);
+}
+
+fix_error get_fix_tag_as_fix_version(const fix_group* const group, unsigned tag, fix_version* const result)
+{
+	CONVERT_TAG(convert_fix_value_to_fix_version);
+}
+
+// enumerated values
+int get_fix_enum_ordinal(const fix_enum_set* const set, const fix_string value)
+{
+	const size_t len = fix_string_length(value);
+
+	if(!set || len == 0)
+		return -1;
+
+	if(!set->slots)
+	{
+		// single character: the bitset, and the rank of the bit
+		const unsigned c = (unsigned char)*value.begin;
+
+		if(len != 1 || c >= 128 || !(set->chars[c >> 6] & ((uint64_t)1 << (c & 63))))
+			return -1;
+
+		const unsigned rank = __builtin_popcountll(set->chars[c >> 6] & (((uint64_t)1 << (c & 63)) - 1))
+							+ (c >= 64 ? __builtin_popcountll(set->chars[0]) : 0);
+
+		return set->ordinals[rank];
+	}
+
+	// perfect hash; must match the one in the specification compiler
+	uint64_t h = len;
+
+	for(const char* s = value.begin; s < value.end; ++s)
+		h = h * 31 + (unsigned char)*s;
+
+	const unsigned slot = set->slots[(h * set->hash_mul) >> set->hash_shift];
+
+	if(slot == 0)
+		return -1;
+
+	const char* const s = set->values[slot - 1];
+
+	return strncmp(s, value.begin, len) == 0 && s[len] == 0 ? (int)slot - 1 : -1;
+}
+
+fix_error get_fix_tag_as_enum(const fix_group* const group, unsigned tag, const fix_enum_set* const set, int* const result)
+{
+	fix_string value;
+	fix_error err = get_fix_tag_as_string(group, tag, &value);
+
+	if(err == FE_OK)
+	{
+		const int ordinal = get_fix_enum_ordinal(set, value);
+
+		if(ordinal < 0)
+			group->error->code = err = FE_INVALID_VALUE;
+		else if(result)
+			*result = ordinal;
+	}
+
+	return err;
+}
 
 int fix_message_type_to_code(const fix_parser* const parser, const fix_string s)
 {
@@ -636,7 +749,7 @@ int fix_message_type_to_code(const fix_parser* const parser, const fix_string s)
 
 	errno = 0;
 
-	const fix_message_info* const info = parser->parser_table(s);
+	const fix_message_info* const info = parser->spec->parser_table(s);
 
 	return info ? info->message_type : -1;
 }
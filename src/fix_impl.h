@@ -34,6 +34,7 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // helper macros
 #define CHAR_TO_INT(c) ((int)(unsigned char)(c))
+#define UNUSED __attribute__((__unused__))
 #define NONE ((unsigned)-1)
 
 // literals
@@ -41,13 +42,69 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define EMPTY_STR	(const fix_string){ NULL, NULL }
 
 // allocator
-#define NEW(T)	calloc(1, sizeof(T))
+#define ALLOC(a, n)			((a)->malloc((a)->ctx, (n)))
+#define REALLOC(a, p, n)	((a)->realloc((a)->ctx, (p), (n)))
+#define FREE(a, p)			((a)->free((a)->ctx, (p)))
 
 // tag info fields access
 #define TAG_TYPE(t)		((tag_value_type)((t) & 3))
 #define TAG_INDEX(t)	((t) >> 2)
 #define TAG_MAIN		TAG_INDEX
 
+// tag info lookup: generated tables first, then the tag info function
+#define NO_TAG_INFO		0xFFFFu
+
+static inline
+unsigned lookup_tag_info(const fix_group_info* const info, unsigned tag)
+{
+	const fix_tag_table* const table = info->tag_table;
+
+	if(!table || (!table->tag_info && !table->hash_keys))
+		return info->get_tag_info(tag);
+
+	unsigned ti;
+
+	if(tag < table->num_tags)
+		ti = table->tag_info[tag];
+	else if(table->hash_keys)
+	{
+		const uint32_t i = (uint32_t)(tag * table->hash_mul) >> table->hash_shift;
+
+		ti = table->hash_keys[i] == tag ? table->hash_values[i] : NO_TAG_INFO;
+	}
+	else
+		return NONE;
+
+	return ti != NO_TAG_INFO ? ti : NONE;
+}
+
+// SIMD kernels
+typedef struct
+{
+	unsigned char (*copy_cs)(char* restrict dest, const char* restrict src, unsigned n);	// copy and checksum
+	unsigned char (*sum_bytes)(const char* s, unsigned n);	// checksum only
+	const char* (*find_soh)(const char* s, const char* const end);	// requires an SOH before 'end'
+	const char* (*find_pair)(const char* s, const char* const end, char c0, char c1);	// returns 'end' if not found
+} fix_kernels;
+
+const fix_kernels* select_kernels(fix_simd_level* const level) __attribute__((nonnull));
+
+// compiled specification
+struct fix_parser_spec
+{
+	// parser table
+	const fix_message_info* (*parser_table)(const fix_string);
+
+	// the best SIMD kernels for the CPU
+	const fix_kernels* kernels;
+	fix_simd_level simd_level;
+
+	// FIX message header
+	char header[sizeof("8=FIXT.1.1|9=") - 1];
+	unsigned header_len;
+	unsigned char header_checksum;
+};
+
 // scanner state
 typedef struct
 {
@@ -56,8 +113,65 @@ typedef struct
 	unsigned counter;
 	int label;
 	unsigned char check_sum;
+	bool verify_checksum;	// checksum is to be verified for the current message
+
+	// remaining input segments
+	const struct iovec* iov;
+	unsigned iov_count;
+
+	// resynchronisation
+	bool lost_sync;						// skipping malformed input
+	bool replay;						// 'src' points to the replay buffer
+	const char *next_src, *next_end;	// input to resume with after the replay
 } scanner_state;
 
+// group arena: a chain of memory blocks for the repeating groups of one message, and the table
+// of those groups, by which they are referenced from the tag values;
+// it is reset for every message, keeping all the memory allocated so far
+typedef struct arena_block
+{
+	struct arena_block* next;
+	size_t size;
+	char data[];
+} arena_block;
+
+typedef struct
+{
+	arena_block *first, *current;
+	char *ptr, *end;
+	fix_group** groups;
+	unsigned num_groups, groups_capacity;
+} group_arena;
+
+// tag projection of a message type: a bit per tag
+typedef struct
+{
+	int msg_type_code;
+	unsigned num_tags;
+	uint64_t* bits;
+} fix_projection;
+
+// group parser frame: a repeating group being read, or skipped if there is no group
+typedef struct
+{
+	const fix_group_info* info;
+	fix_group* group;
+	unsigned len, num_nodes;	// expected and actual number of nodes
+	unsigned len_tag;			// length tag and its context, for error reporting
+	fix_string len_ctx;
+} group_frame;
+
+// batch slot, holding the message buffer and the groups of one message from a batch
+typedef struct
+{
+	fix_parser_result result;
+	unsigned root_capacity;
+	bool root_converted;
+	group_arena arena;
+	char* body;
+	unsigned body_capacity;
+} batch_slot;
+
 // parser
 struct fix_parser
 {
@@ -74,42 +188,158 @@ struct fix_parser
 	char* body;
 	unsigned body_length, body_capacity;
 
+	// raw message, either in the buffer above or in the input
+	const char* raw;
+
+	// replay buffer for the bytes following a framing error
+	char* replay;
+	unsigned replay_capacity;
+
+	// statistics
+	fix_parser_stats stats;
+
 	// root group capacity
 	unsigned root_capacity;	// max number of tag_value's
+	bool root_converted;	// the tag values are followed by their side slots for eager conversion
+
+	// generation of the current message, as stored in the tag values
+	uint32_t stamp;
+
+	// memory for the repeating groups
+	group_arena arena;
+
+	// stack of the nested repeating groups being parsed
+	group_frame* group_stack;
+
+	// parser limits, and the number of tags the current message may still have
+	fix_parser_limits limits;
+	unsigned tags_left;
+
+	// parser state of the current message: the next tag while suspended in lazy mode,
+	// or the final error details once the message is parsed
+	fix_error_details message_state;
+
+	// message batch
+	batch_slot* batch;
+	unsigned batch_capacity;
+
+	// memory allocator
+	fix_allocator allocator;
+
+	// specification, either shared or the parser's own one
+	const fix_parser_spec* spec;
+	fix_parser_spec own_spec;
 
 	// parser settings
-	const fix_message_info* (*parser_table)(const fix_string);
+	unsigned flags;
 
-	// FIX message header
-	char header[sizeof("8=FIXT.1.1|9=") - 1];
-	unsigned header_len;
-	unsigned char header_checksum;
+	// tag projections, and the one of the current message
+	fix_projection* projections;
+	unsigned num_projections;
+	const fix_projection* projection;
+
+	// validation level
+	fix_validation_level validation;
+
+	// checksum policy
+	fix_checksum_policy checksum_policy;
+	unsigned checksum_sample_rate, checksum_counter;
+
+	// SIMD kernels
+	const fix_kernels* kernels;
+	fix_simd_level simd_level;
 };
 
 // parser configuration
 #define INITIAL_BODY_SIZE	200
 #define INITIAL_NUM_TAGS	20
+#define ARENA_BLOCK_SIZE	4096
+#define MAX_PREALLOC_SIZE	65536	// message buffers up to this size are allocated up front
 
-// fix tag value
-typedef union
+// default parser limits
+#define DEFAULT_MESSAGE_LENGTH	100000
+#define DEFAULT_GROUP_SIZE		1000
+#define DEFAULT_GROUP_DEPTH		16
+
+// initial size of a message buffer: room for the longest message, if the length limit is low enough
+static inline
+unsigned initial_body_size(const fix_parser* const parser)
 {
-	fix_group* group;
-	fix_string value;
+	const unsigned n = parser->limits.max_message_length + sizeof("8=FIXT.1.1|9=1234567|10=123|") - 1;
+
+	return n <= MAX_PREALLOC_SIZE ? n : INITIAL_BODY_SIZE;
+}
+
+// fix tag value: either a string, as its offset from the beginning of the message and its length,
+// or a group, as its index in the group table of the arena; the upper bits of the length hold
+// the generation of the message, so the values left from the previous messages read as empty
+typedef struct
+{
+	uint32_t offset, length;
 } tag_value;
 
+#define VALUE_BITS		22
+#define VALUE_MASK		((1u << VALUE_BITS) - 1)
+#define GROUP_VALUE		VALUE_MASK	// length of a group value
+
+_Static_assert(MAX_MESSAGE_LENGTH + 32 < GROUP_VALUE, "tag value length does not fit in the value bits");
+
+// length of the tag value, or 0 if the value is not from the message of the given stamp
+static inline
+unsigned value_length(const tag_value* const pv, uint32_t stamp)
+{
+	return (pv->length & ~VALUE_MASK) == stamp ? pv->length & VALUE_MASK : 0;
+}
+
+// tag value converted while parsing, in the side slot of the tag
+typedef struct
+{
+	uint64_t year : 14, month : 4, day : 5, hour : 5, minute : 6, second : 6, millisecond : 10;
+} packed_timestamp;
+
+typedef union
+{
+	long l;
+	double d;
+	packed_timestamp ts;
+} converted_value;
+
+// value type of the tag at the given index
+static inline
+fix_value_type value_type(const fix_group_info* const info, unsigned index)
+{
+	return info->value_types ? (fix_value_type)info->value_types[index] : FIX_VALUE_STRING;
+}
+
 // fix group node
 struct fix_group
 {
 	const fix_group_info* info;		// group info
 	fix_error_details* error;		// error details pointer
-	fix_group* next_gc;				// gc chain
+	const fix_allocator* allocator;	// parser's allocator
+	const group_arena* arena;		// arena of the message, with the table of its groups
+	const char* base;				// beginning of the message, for the string values
+	fix_parser* lazy;				// parser to resume with, for the root group in lazy mode
+	uint32_t stamp;					// generation of the message, as stored in the tag values
 	unsigned num_nodes, node_base;	// number of nodes, iterator
+	converted_value* converted;		// side slots of the tags, in eager conversion mode, or NULL
 	tag_value tags[];				// tag space
 };
 
 // scanner
 bool init_scanner(fix_parser* parser);
 bool extract_next_message(fix_parser* const parser) __attribute__((nonnull));
+bool extract_framed_message(fix_parser* const parser, const char* const begin, const fix_frame* const frame)
+	__attribute__((nonnull));
+fix_error verify_message_checksum(const fix_parser* const parser) __attribute__((nonnull));
+bool has_partial_message(const fix_parser* const parser) __attribute__((nonnull));
+
+// parser
+bool set_scanner_input(fix_parser* const parser, const void* bytes, unsigned num_bytes);
+
+// tag value as string, with its converted value if the tag is of the given type and has been converted while parsing
+fix_error get_tag_value(const fix_group* const group, unsigned tag, fix_value_type type,
+						fix_string* const result, const converted_value** const converted);
 
 // utils -----------------------------------------------------------------------------
 // error setters
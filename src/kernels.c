@@ -0,0 +1,410 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "fix_impl.h"
+#include <stdint.h>
+
+// x86 kernels are compiled with per-function target attributes, and selected at run-time
+#if (defined __GNUC__ || defined __clang__) && (defined __x86_64__ || defined __i386__)
+#define X86_KERNELS
+#include <immintrin.h>
+
+#define SSE2	__attribute__((__target__("sse2")))
+#define AVX2	__attribute__((__target__("avx2")))
+#define AVX512	__attribute__((__target__("avx512f,avx512bw")))
+#endif
+
+// scalar kernels ---------------------------------------------------------------------------------
+static
+unsigned char copy_cs_scalar(char* restrict p, const char* restrict s, unsigned n)
+{
+	unsigned char cs = 0;
+
+	for(const char* const end = s + n; s < end; )
+		cs += (*p++ = *s++);
+
+	return cs;
+}
+
+static
+unsigned char sum_bytes_scalar(const char* s, unsigned n)
+{
+	unsigned char cs = 0;
+
+	for(const char* const end = s + n; s < end; )
+		cs += *s++;
+
+	return cs;
+}
+
+static
+const char* find_soh_scalar(const char* s, const char* const end)
+{
+	// here we are guaranteed to have an SOH before the end of the value, so we check
+	// a word at a time while there is a whole word left, and then byte by byte.
+
+	for(; end - s >= (long)sizeof(unsigned long); s += sizeof(unsigned long))
+	{
+		unsigned long t = *(const unsigned long*)s;
+
+		if((t & 0xFFul) == 1ul) return s;
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 1;
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 2;
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 3;
+#if __SIZEOF_LONG__ > 4
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 4;
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 5;
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 6;
+		t >>= 8;
+		if((t & 0xFFul) == 1ul) return s + 7;
+#endif
+	}
+
+	while(*s != SOH)
+		++s;
+
+	return s;
+}
+
+static
+const char* find_pair_scalar(const char* s, const char* const end, char c0, char c1)
+{
+	while(end - s > 1 && (s = memchr(s, c0, end - s - 1)))
+	{
+		if(s[1] == c1)
+			return s;
+
+		++s;
+	}
+
+	return end;
+}
+
+#ifdef X86_KERNELS
+
+// The checksum kernels accumulate the byte sums in 64-bit lanes using the PSADBW instruction,
+// and the checksum itself is the lowest byte of the total.
+// The SOH search kernels never read at or after the end of the value, finishing it
+// with a smaller kernel or a masked load.
+
+// SSE2 kernels -----------------------------------------------------------------------------------
+SSE2 static inline
+unsigned char reduce_sse2(const __m128i acc)
+{
+	return (unsigned char)_mm_cvtsi128_si32(_mm_add_epi32(acc, _mm_srli_si128(acc, 8)));
+}
+
+SSE2 static
+unsigned char copy_cs_sse2(char* restrict p, const char* restrict s, unsigned n)
+{
+	const char* const end = s + n;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+
+	for(; end - s >= 16; s += 16, p += 16)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)s);
+
+		_mm_storeu_si128((__m128i*)p, v);
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+	}
+
+	if(end - s >= 8)
+	{
+		const __m128i v = _mm_loadl_epi64((const __m128i*)s);
+
+		_mm_storel_epi64((__m128i*)p, v);
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+		s += 8;
+		p += 8;
+	}
+
+	return reduce_sse2(acc) + copy_cs_scalar(p, s, end - s);
+}
+
+SSE2 static
+unsigned char sum_bytes_sse2(const char* s, unsigned n)
+{
+	const char* const end = s + n;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+
+	for(; end - s >= 16; s += 16)
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)s), zero));
+
+	if(end - s >= 8)
+	{
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i*)s), zero));
+		s += 8;
+	}
+
+	return reduce_sse2(acc) + sum_bytes_scalar(s, end - s);
+}
+
+SSE2 static
+const char* find_soh_sse2(const char* s, const char* const end)
+{
+	const __m128i soh = _mm_set1_epi8(SOH);
+
+	for(; end - s >= 16; s += 16)
+	{
+		const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)s), soh));
+
+		if(mask)
+			return s + __builtin_ctz(mask);
+	}
+
+	return find_soh_scalar(s, end);
+}
+
+SSE2 static
+const char* find_pair_sse2(const char* s, const char* const end, char c0, char c1)
+{
+	const __m128i v0 = _mm_set1_epi8(c0), v1 = _mm_set1_epi8(c1);
+
+	for(; end - s > 16; s += 16)
+	{
+		const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)s), v0))
+							& _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + 1)), v1));
+
+		if(mask)
+			return s + __builtin_ctz(mask);
+	}
+
+	return find_pair_scalar(s, end, c0, c1);
+}
+
+// AVX2 kernels -----------------------------------------------------------------------------------
+AVX2 static inline
+unsigned char reduce_avx2(const __m256i acc)
+{
+	return reduce_sse2(_mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+}
+
+AVX2 static
+unsigned char copy_cs_avx2(char* restrict p, const char* restrict s, unsigned n)
+{
+	const char* const end = s + n;
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+
+	for(; end - s >= 32; s += 32, p += 32)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)s);
+
+		_mm256_storeu_si256((__m256i*)p, v);
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+	}
+
+	return reduce_avx2(acc) + copy_cs_sse2(p, s, end - s);
+}
+
+AVX2 static
+unsigned char sum_bytes_avx2(const char* s, unsigned n)
+{
+	const char* const end = s + n;
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+
+	for(; end - s >= 32; s += 32)
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)s), zero));
+
+	return reduce_avx2(acc) + sum_bytes_sse2(s, end - s);
+}
+
+AVX2 static
+const char* find_soh_avx2(const char* s, const char* const end)
+{
+	const __m256i soh = _mm256_set1_epi8(SOH);
+
+	for(; end - s >= 32; s += 32)
+	{
+		const unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)s), soh));
+
+		if(mask)
+			return s + __builtin_ctz(mask);
+	}
+
+	return find_soh_sse2(s, end);
+}
+
+AVX2 static
+const char* find_pair_avx2(const char* s, const char* const end, char c0, char c1)
+{
+	const __m256i v0 = _mm256_set1_epi8(c0), v1 = _mm256_set1_epi8(c1);
+
+	for(; end - s > 32; s += 32)
+	{
+		const unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)s), v0))
+							& _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + 1)), v1));
+
+		if(mask)
+			return s + __builtin_ctz(mask);
+	}
+
+	return find_pair_sse2(s, end, c0, c1);
+}
+
+// AVX-512 kernels --------------------------------------------------------------------------------
+// tails are processed with masked loads and stores, which never fault on the masked out bytes
+AVX512 static
+unsigned char copy_cs_avx512(char* restrict p, const char* restrict s, unsigned n)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i acc = zero;
+
+	for(; n >= 64; n -= 64, s += 64, p += 64)
+	{
+		const __m512i v = _mm512_loadu_si512(s);
+
+		_mm512_storeu_si512(p, v);
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(v, zero));
+	}
+
+	if(n > 0)
+	{
+		const __mmask64 m = (1ull << n) - 1;
+		const __m512i v = _mm512_maskz_loadu_epi8(m, s);
+
+		_mm512_mask_storeu_epi8(p, m, v);
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(v, zero));
+	}
+
+	return (unsigned char)_mm512_reduce_add_epi64(acc);
+}
+
+AVX512 static
+unsigned char sum_bytes_avx512(const char* s, unsigned n)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i acc = zero;
+
+	for(; n >= 64; n -= 64, s += 64)
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_loadu_si512(s), zero));
+
+	if(n > 0)
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_maskz_loadu_epi8((1ull << n) - 1, s), zero));
+
+	return (unsigned char)_mm512_reduce_add_epi64(acc);
+}
+
+AVX512 static
+const char* find_soh_avx512(const char* s, const char* const end)
+{
+	const __m512i soh = _mm512_set1_epi8(SOH);
+
+	for(; end - s >= 64; s += 64)
+	{
+		const unsigned long long mask = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s), soh);
+
+		if(mask)
+			return s + __builtin_ctzll(mask);
+	}
+
+	return s + __builtin_ctzll(_mm512_cmpeq_epi8_mask(_mm512_maskz_loadu_epi8((1ull << (end - s)) - 1, s), soh));
+}
+
+AVX512 static
+const char* find_pair_avx512(const char* s, const char* const end, char c0, char c1)
+{
+	const __m512i v0 = _mm512_set1_epi8(c0), v1 = _mm512_set1_epi8(c1);
+
+	for(; end - s > 64; s += 64)
+	{
+		const unsigned long long mask = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s), v0)
+									  & _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + 1), v1);
+
+		if(mask)
+			return s + __builtin_ctzll(mask);
+	}
+
+	return find_pair_avx2(s, end, c0, c1);
+}
+
+#endif	// #ifdef X86_KERNELS
+
+// kernel selection -------------------------------------------------------------------------------
+static const fix_kernels kernels[] =
+{
+	[FIX_SIMD_NONE] = { copy_cs_scalar, sum_bytes_scalar, find_soh_scalar, find_pair_scalar },
+#ifdef X86_KERNELS
+	[FIX_SIMD_SSE2] = { copy_cs_sse2, sum_bytes_sse2, find_soh_sse2, find_pair_sse2 },
+	[FIX_SIMD_AVX2] = { copy_cs_avx2, sum_bytes_avx2, find_soh_avx2, find_pair_avx2 },
+	[FIX_SIMD_AVX512] = { copy_cs_avx512, sum_bytes_avx512, find_soh_avx512, find_pair_avx512 }
+#endif
+};
+
+// check if the given SIMD level is supported by both the build and the CPU
+static
+bool simd_level_supported(fix_simd_level level)
+{
+	switch(level)
+	{
+		case FIX_SIMD_NONE:
+			return true;
+#ifdef X86_KERNELS
+		case FIX_SIMD_SSE2:
+			return __builtin_cpu_supports("sse2");
+		case FIX_SIMD_AVX2:
+			return __builtin_cpu_supports("avx2");
+		case FIX_SIMD_AVX512:
+			return __builtin_cpu_supports("avx512bw");
+#endif
+		default:
+			return false;
+	}
+}
+
+// best level available
+static
+fix_simd_level best_simd_level()
+{
+	fix_simd_level level = FIX_SIMD_AVX512;
+
+	while(!simd_level_supported(level))
+		--level;
+
+	return level;
+}
+
+// returns NULL if the level is not supported
+const fix_kernels* select_kernels(fix_simd_level* const level)
+{
+	if(*level == FIX_SIMD_AUTO)
+		*level = best_simd_level();
+	else if(!simd_level_supported(*level))
+		return NULL;
+
+	return &kernels[*level];
+}
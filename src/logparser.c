@@ -0,0 +1,342 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define _GNU_SOURCE	// memmem()
+
+#include "fix_impl.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Parallel log parser: the input is split into chunks starting at the begin strings of the messages,
+// and the chunks are taken in turn by a pool of workers, each with its own parser of the shared
+// specification. A worker parses its chunk in batches; in ordered mode the first batch is parsed
+// in parallel with the other workers, and the delivery waits for all the previous chunks to be delivered.
+
+#define DEFAULT_CHUNK_SIZE	(256u << 10)
+#define LOG_BATCH_SIZE		1024u
+#define MAX_PIECE_SIZE		(1u << 30)	// maximum number of bytes passed to the parser at once
+
+// workers are kept on separate cache lines
+#define CACHE_LINE	64
+
+typedef struct fix_log fix_log;
+
+typedef struct
+{
+	_Alignas(CACHE_LINE) fix_log* log;
+	fix_parser* parser;
+	pthread_t thread;
+	bool started;
+	const fix_parser_result* results[LOG_BATCH_SIZE];
+} log_worker;
+
+struct fix_log
+{
+	// input
+	const char *begin, *end;
+	size_t chunk_size, num_chunks;
+
+	// delivery
+	fix_message_handler handler;
+	void* ctx;
+	bool ordered;
+
+	// the next chunk to take, and the next one to deliver in ordered mode
+	_Alignas(CACHE_LINE) atomic_size_t next_chunk;
+	_Alignas(CACHE_LINE) atomic_size_t next_delivery;
+
+	// the first chunk failed, and its error
+	_Alignas(CACHE_LINE) atomic_bool stopped;
+	pthread_mutex_t lock;
+	size_t error_chunk;
+	fix_error error;
+};
+
+// chunk boundary: the first begin string at or after the given offset, following an SOH or a line break
+static
+const char* chunk_boundary(const fix_log* const log, size_t offset)
+{
+	if(offset == 0)
+		return log->begin;
+
+	for(const char* s = log->begin + offset; s < log->end; ++s)
+	{
+		if(!(s = memmem(s, log->end - s, "8=FIX", sizeof("8=FIX") - 1)))
+			break;
+
+		if(s[-1] == SOH || s[-1] == '\n' || s[-1] == '\r')
+			return s;
+	}
+
+	return log->end;
+}
+
+// error of a chunk; only the earliest one is kept
+static
+void set_log_error(fix_log* const log, size_t chunk, fix_error error)
+{
+	pthread_mutex_lock(&log->lock);
+
+	if(chunk < log->error_chunk)
+	{
+		log->error_chunk = chunk;
+		log->error = error;
+	}
+
+	pthread_mutex_unlock(&log->lock);
+	atomic_store_explicit(&log->stopped, true, memory_order_release);
+}
+
+// in ordered mode, wait for all the previous chunks to be delivered
+static
+bool wait_for_turn(fix_log* const log, size_t chunk)
+{
+	while(atomic_load_explicit(&log->next_delivery, memory_order_acquire) != chunk)
+	{
+		if(atomic_load_explicit(&log->stopped, memory_order_acquire))
+			return false;
+
+		sched_yield();
+	}
+
+	return true;
+}
+
+// chunk parser
+static
+bool parse_chunk(log_worker* const worker, size_t chunk)
+{
+	fix_log* const log = worker->log;
+	fix_parser* const parser = worker->parser;
+	const char* const end = chunk_boundary(log, (chunk + 1) * log->chunk_size);
+	bool turn = !log->ordered;
+
+	reset_fix_parser(parser);
+
+	for(const char* s = chunk_boundary(log, chunk * log->chunk_size); s < end; )
+	{
+		const unsigned n = end - s < MAX_PIECE_SIZE ? (unsigned)(end - s) : MAX_PIECE_SIZE;
+
+		for(unsigned k = get_first_fix_message_batch(parser, s, n, worker->results, LOG_BATCH_SIZE);
+			k > 0;
+			k = get_next_fix_message_batch(parser, worker->results, LOG_BATCH_SIZE))
+		{
+			if(!turn && !(turn = wait_for_turn(log, chunk)))
+				return false;
+
+			for(unsigned i = 0; i < k; ++i)
+				log->handler(worker->results[i], log->ctx);
+
+			release_fix_message_batch(parser);
+		}
+
+		if(parser->result.error.code > FE_OTHER)
+			break;
+
+		s += n;
+	}
+
+	if(!turn && !wait_for_turn(log, chunk))
+		return false;
+
+	// a fatal error, or a message not complete within the chunk
+	const fix_error error = parser->result.error.code > FE_OTHER ? parser->result.error.code
+						  : has_partial_message(parser) ? FE_INVALID_MESSAGE_LENGTH
+						  : FE_OK;
+
+	if(error != FE_OK)
+	{
+		set_log_error(log, chunk, error);
+		return false;
+	}
+
+	atomic_store_explicit(&log->next_delivery, chunk + 1, memory_order_release);
+	return true;
+}
+
+// worker thread
+static
+void* log_worker_main(void* arg)
+{
+	log_worker* const worker = arg;
+	fix_log* const log = worker->log;
+
+	while(!atomic_load_explicit(&log->stopped, memory_order_acquire))
+	{
+		const size_t chunk = atomic_fetch_add_explicit(&log->next_chunk, 1, memory_order_relaxed);
+
+		if(chunk >= log->num_chunks || !parse_chunk(worker, chunk))
+			break;
+	}
+
+	return NULL;
+}
+
+// log parser interface implementation ----------------------------------------------------------
+fix_error parse_fix_log(const fix_parser_spec* const spec, const void* bytes, size_t num_bytes,
+						const fix_log_options* const options, fix_message_handler handler, void* ctx)
+{
+	if(!spec || (!bytes && num_bytes > 0) || !handler)
+	{
+		errno = EINVAL;
+		return FE_OTHER;
+	}
+
+	if(num_bytes == 0)
+		return FE_OK;
+
+	// options
+	static const fix_log_options default_options = { 0, 0, 0, false };
+	const fix_log_options* const opt = options ? options : &default_options;
+	unsigned num_threads = opt->num_threads;
+
+	if(num_threads == 0)
+	{
+		const long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+		num_threads = n > 0 ? (unsigned)n : 1;
+	}
+
+	// set-up
+	fix_log log = {
+		.begin = bytes,
+		.end = (const char*)bytes + num_bytes,
+		.chunk_size = opt->chunk_size ? opt->chunk_size : DEFAULT_CHUNK_SIZE,
+		.handler = handler,
+		.ctx = ctx,
+		.ordered = opt->ordered,
+		.error_chunk = SIZE_MAX,
+		.error = FE_OK
+	};
+
+	log.num_chunks = (num_bytes + log.chunk_size - 1) / log.chunk_size;
+
+	if(num_threads > log.num_chunks)
+		num_threads = log.num_chunks;
+
+	atomic_init(&log.next_chunk, 0);
+	atomic_init(&log.next_delivery, 0);
+	atomic_init(&log.stopped, false);
+
+	const size_t workers_size = (num_threads * sizeof(log_worker) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+	log_worker* const workers = aligned_alloc(CACHE_LINE, workers_size);
+
+	if(!workers)
+		return FE_OUT_OF_MEMORY;
+
+	pthread_mutex_init(&log.lock, NULL);
+
+	// parsers
+	unsigned n = 0;
+
+	for(; n < num_threads; ++n)
+	{
+		log_worker* const worker = &workers[n];
+
+		worker->log = &log;
+		worker->started = false;
+
+		if(!(worker->parser = create_fix_parser_from_spec(spec, NULL)))
+			break;
+
+		set_fix_parser_flags(worker->parser, opt->flags | FIX_ZERO_COPY | FIX_LINE_BREAKS);
+	}
+
+	if(n < num_threads)
+		log.error = FE_OUT_OF_MEMORY;
+	else
+	{
+		// workers: the first one runs on the calling thread, and the others as many as get started
+		for(unsigned i = 1; i < num_threads; ++i)
+			workers[i].started = pthread_create(&workers[i].thread, NULL, log_worker_main, &workers[i]) == 0;
+
+		log_worker_main(&workers[0]);
+
+		for(unsigned i = 1; i < num_threads; ++i)
+			if(workers[i].started)
+				pthread_join(workers[i].thread, NULL);
+	}
+
+	// clean-up
+	for(unsigned i = 0; i < n; ++i)
+		free_fix_parser(workers[i].parser);
+
+	free(workers);
+	pthread_mutex_destroy(&log.lock);
+	return log.error;
+}
+
+fix_error parse_fix_log_file(const fix_parser_spec* const spec, const char* const file_name,
+							 const fix_log_options* const options, fix_message_handler handler, void* ctx)
+{
+	if(!file_name)
+	{
+		errno = EINVAL;
+		return FE_OTHER;
+	}
+
+	const int fd = open(file_name, O_RDONLY);
+
+	if(fd < 0)
+		return FE_OTHER;
+
+	struct stat st;
+
+	if(fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return FE_OTHER;
+	}
+
+	if(st.st_size == 0)
+	{
+		close(fd);
+		return parse_fix_log(spec, NULL, 0, options, handler, ctx);
+	}
+
+	void* const p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if(p == MAP_FAILED)
+		return FE_OTHER;
+
+	madvise(p, st.st_size, MADV_WILLNEED);
+
+	const fix_error err = parse_fix_log(spec, p, st.st_size, options, handler, ctx);
+
+	munmap(p, st.st_size);
+	return err;
+}
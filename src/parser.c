@@ -28,43 +28,123 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "fix_impl.h"
 #include <errno.h>
+#include <limits.h>
 
-#ifdef USE_SSE
-#include <xmmintrin.h>
-#endif
+// group arena
+#define ARENA_ALIGN(n)	(((n) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
 
-// groups cleanup
 static
-void free_groups(fix_group* group)
+void* arena_alloc(fix_parser* const parser, group_arena* const arena, size_t n)
 {
-	while(group)
+	n = ARENA_ALIGN(n);
+
+	if((size_t)(arena->end - arena->ptr) < n)
+	{
+		// move to the next block big enough, or allocate a new one at the end of the chain
+		arena_block* block = arena->current ? arena->current->next : arena->first;
+
+		while(block && block->size < n)
+		{
+			arena->current = block;
+			block = block->next;
+		}
+
+		if(!block)
+		{
+			const size_t size = n > ARENA_BLOCK_SIZE ? n : ARENA_BLOCK_SIZE;
+
+			if(!(block = ALLOC(&parser->allocator, sizeof(arena_block) + size)))
+				return NULL;
+
+			*block = (arena_block){ NULL, size };
+
+			if(arena->current)
+				arena->current->next = block;
+			else
+				arena->first = block;
+
+			++parser->stats.group_allocs;
+			parser->stats.group_memory += size;
+		}
+
+		arena->current = block;
+		arena->ptr = block->data;
+		arena->end = block->data + block->size;
+	}
+
+	void* const p = arena->ptr;
+
+	arena->ptr += n;
+	return p;
+}
+
+// adds the group to the group table of the arena, returning its index, or NONE if out of memory
+static
+unsigned arena_add_group(fix_parser* const parser, group_arena* const arena, fix_group* const group)
+{
+	if(arena->num_groups == arena->groups_capacity)
+	{
+		const unsigned n = arena->groups_capacity > 0 ? 2 * arena->groups_capacity : 16;
+		fix_group** const p = REALLOC(&parser->allocator, arena->groups, n * sizeof(fix_group*));
+
+		if(!p)
+			return NONE;
+
+		++parser->stats.group_allocs;
+		parser->stats.group_memory += (n - arena->groups_capacity) * sizeof(fix_group*);
+		arena->groups = p;
+		arena->groups_capacity = n;
+	}
+
+	arena->groups[arena->num_groups] = group;
+	return arena->num_groups++;
+}
+
+static inline
+void reset_arena(group_arena* const arena)
+{
+	arena->current = NULL;
+	arena->ptr = arena->end = NULL;
+	arena->num_groups = 0;
+}
+
+static
+void free_arena(const fix_allocator* const allocator, group_arena* const arena)
+{
+	for(arena_block* block = arena->first; block; )
 	{
-		fix_group* const next = group->next_gc;
+		arena_block* const next = block->next;
 
-		free(group);
-		group = next;
+		FREE(allocator, block);
+		block = next;
 	}
+
+	FREE(allocator, arena->groups);
+	*arena = (group_arena){ NULL, NULL, NULL, NULL, NULL, 0, 0 };
 }
 
-// group allocator
+// group allocator; stores the group reference in the given tag value
 static
-fix_group* alloc_group(fix_parser* const parser, const fix_group_info* const ginfo, unsigned num_nodes)
+fix_group* alloc_group(fix_parser* const parser, const fix_group_info* const ginfo, unsigned num_nodes, tag_value* const value)
 {
-	// allocate memory
-	const unsigned n = num_nodes * ginfo->node_size * sizeof(tag_value);
-	fix_group* const group = malloc(sizeof(fix_group) + n);
+	// allocate memory, with the side slots in eager conversion mode
+	const size_t num_tags = (size_t)num_nodes * ginfo->node_size, n = num_tags * sizeof(tag_value);
+	const bool eager = parser->flags & FIX_EAGER_CONVERSION;
+	fix_group* const group = arena_alloc(parser, &parser->arena, sizeof(fix_group) + n + (eager ? num_tags * sizeof(converted_value) : 0));
+	const unsigned index = group ? arena_add_group(parser, &parser->arena, group) : NONE;
 
-	if(!group)
+	if(index == NONE)
 	{
 		set_fatal_error(parser, FE_OUT_OF_MEMORY);
 		return NULL;
 	}
 
 	// set-up
-	*group = (fix_group){ ginfo, &parser->result.error, parser->result.root->next_gc, num_nodes, 0 };
-	parser->result.root->next_gc = group;
+	*group = (fix_group){ ginfo, &parser->result.error, &parser->allocator, &parser->arena, parser->raw, NULL,
+						  parser->stamp, num_nodes, 0, eager ? (converted_value*)(group->tags + num_tags) : NULL };
+	*value = (tag_value){ index, GROUP_VALUE | parser->stamp };
 
-	// clear tag values
+	// clear tag values, as the arena memory may hold anything
 	memset(group->tags, 0, n);
 
 	// all done
@@ -77,19 +157,31 @@ bool prepare_root_group(fix_parser* const parser, const fix_group_info* const in
 {
 	fix_parser_result* const result = &parser->result;
 
-	// clear child groups, if any
-	if(result->root)
-	{
-		free_groups(result->root->next_gc);
-		result->root->next_gc = NULL;
-	}
+	// release child groups, if any
+	reset_arena(&parser->arena);
 
 	// required number of tags
 	const unsigned n = info ? info->node_size : INITIAL_NUM_TAGS;
 
-	if(n > parser->root_capacity)
+	// new generation; the root memory keeps the stamp of the last message it held
+	const uint32_t last_stamp = parser->root_capacity > 0 ? result->root->stamp : 0;
+
+	parser->stamp += 1u << VALUE_BITS;
+
+	if(parser->stamp == 0)	// wrap around, skipping the generation of the cleared slots
+		parser->stamp = 1u << VALUE_BITS;
+
+	// the side slots are only added in eager conversion mode, and kept from then on
+	const bool eager = parser->flags & FIX_EAGER_CONVERSION;
+
+	if(n > parser->root_capacity || (eager && !parser->root_converted))
 	{
-		fix_group* const group = realloc(result->root, sizeof(fix_group) + n * sizeof(tag_value));
+		// the tag values followed by their side slots, if any
+		const bool converted = eager || parser->root_converted;
+		const unsigned capacity = n > parser->root_capacity ? n : parser->root_capacity;
+		const size_t slot_size = sizeof(tag_value) + (converted ? sizeof(converted_value) : 0),
+					 old_slot_size = sizeof(tag_value) + (parser->root_converted ? sizeof(converted_value) : 0);
+		fix_group* const group = REALLOC(&parser->allocator, result->root, sizeof(fix_group) + capacity * slot_size);
 
 		if(!group)
 		{
@@ -97,16 +189,26 @@ bool prepare_root_group(fix_parser* const parser, const fix_group_info* const in
 			return false;
 		}
 
+		// clear the new tag values
+		memset(group->tags + parser->root_capacity, 0, (capacity - parser->root_capacity) * sizeof(tag_value));
+
 		// update parser
 		result->root = group;
-		parser->root_capacity = n;
+		parser->stats.group_memory += capacity * slot_size - parser->root_capacity * old_slot_size
+									+ (parser->root_capacity == 0 ? sizeof(fix_group) : 0);
+		parser->root_capacity = capacity;
+		parser->root_converted = converted;
+		++parser->stats.group_allocs;
 	}
 
-	// set-up
-	*result->root = (fix_group){ info, &result->error, NULL, 1, 0 };
+	// the tag values of the previous messages read as empty, so they only get cleared after a wrap-around
+	if(last_stamp >= parser->stamp)
+		memset(result->root->tags, 0, parser->root_capacity * sizeof(tag_value));
 
-	// clear tag values
-	memset(&result->root->tags, 0, n * sizeof(tag_value));
+	// set-up
+	*result->root = (fix_group){ info, &result->error, &parser->allocator, &parser->arena, parser->raw, NULL,
+								 parser->stamp, 1, 0,
+								 eager ? (converted_value*)(result->root->tags + parser->root_capacity) : NULL };
 	return true;
 }
 
@@ -161,14 +263,21 @@ unsigned next_tag(fix_parser* const parser)
 	// read tag
 	const unsigned tag = parser->result.error.tag = read_uint(parser, '=');
 
-	if(tag != 0)
+	if(tag == 0)
 	{
-		parser->result.error.code = FE_OK;
-		return tag;
+		parser->result.error.code = FE_INVALID_TAG;
+		return 0;
 	}
 
-	parser->result.error.code = FE_INVALID_TAG;
-	return 0;
+	// tag limit, the context names the limit
+	if(parser->tags_left-- == 0)
+	{
+		set_error_ctx(&parser->result.error, FE_OTHER, tag, CONST_LIT("max_tags"));
+		return 0;
+	}
+
+	parser->result.error.code = FE_OK;
+	return tag;
 }
 
 // match the next tag
@@ -208,77 +317,31 @@ unsigned read_uint_value(fix_parser* const parser)
 	return 0;
 }
 
-static
-const char* find_soh(const char* s)
-{
-	// here we are guaranteed to have at least 8 bytes ("|10=123|")
-	// left at the location pointed to by the input pointer, so we can safely
-	// read ahead without touching the memory outside the buffer.
-
-#ifdef USE_SSE
-
-	// pattern to compare to.
-	// lower half is all SOH's, upper half is all FF's, just to compare negatively
-	// to the upper nulls in the input
-	const __m128i patt = _mm_set_epi32(-1, -1, 0x01010101, 0x01010101);
-
-	// mask
-	int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(patt, _mm_loadl_epi64((const __m128i*)s)));
-
-	while(mask == 0)
-	{
-		s += 8;
-		mask = _mm_movemask_epi8(_mm_cmpeq_epi8(patt, _mm_loadl_epi64((const __m128i*)s)));
-	}
-
-	return s + __builtin_ctz(mask);
-
-#else
-
-	for(;;)
-	{
-		unsigned long t = *(const unsigned long*)s;
-
-		if((t & 0xFFul) == 1ul) return s;
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 1;
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 2;
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 3;
-#if __SIZEOF_LONG__ > 4
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 4;
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 5;
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 6;
-		t >>= 8;
-		if((t & 0xFFul) == 1ul) return s + 7;
-#endif
-		s += sizeof(unsigned long);
-	}
-
-#endif
-}
-
 // read bytes to the first SOH, i.e., a FIX string
 static
 fix_string read_string(fix_parser* const parser)
 {
-	const fix_string res = { parser->frame.begin, find_soh(parser->frame.begin) };
+	const fix_string res = { parser->frame.begin, parser->kernels->find_soh(parser->frame.begin, parser->frame.end) };
 
 	parser->frame.begin = res.end + 1;
 	return res;
 }
 
+// string value relative to the beginning of the message
+static inline
+tag_value make_tag_value(const fix_parser* const parser, const fix_string s)
+{
+	return (tag_value){ (uint32_t)(s.begin - parser->raw), (uint32_t)(s.end - s.begin) | parser->stamp };
+}
+
 // helpers for retrieving the address of the tag value structure
 static
-tag_value* tag_value_checked_ptr(fix_group* const group, unsigned tag_info)
+tag_value* tag_value_checked_ptr(const fix_parser* const parser, fix_group* const group, unsigned tag_info)
 {
 	tag_value* const ptr = &group->tags[group->node_base + TAG_INDEX(tag_info)];
 
-	if(!ptr->group)	// check for duplicate
+	// check for duplicate; with relaxed validation the last value wins
+	if(value_length(ptr, group->stamp) == 0 || parser->validation != FIX_VALIDATION_STRICT)
 		return ptr;
 
 	group->error->code = FE_DUPLICATE_TAG;
@@ -286,42 +349,88 @@ tag_value* tag_value_checked_ptr(fix_group* const group, unsigned tag_info)
 }
 
 static
-tag_value* binary_tag_value_checked_ptr(fix_group* const group, unsigned len_tag_info)
+tag_value* binary_tag_value_checked_ptr(const fix_parser* const parser, fix_group* const group, unsigned len_tag_info)
 {
-	const unsigned ti = group->info->get_tag_info(TAG_MAIN(len_tag_info));
+	const unsigned ti = lookup_tag_info(group->info, TAG_MAIN(len_tag_info));
 
 	if(ti != NONE && TAG_TYPE(ti) == TAG_BINARY)
-		return tag_value_checked_ptr(group, ti);
+		return tag_value_checked_ptr(parser, group, ti);
 
 	// invalid parser spec., must never happen
 	group->error->code = FE_INVALID_PARSER_STATE;
 	return NULL;
 }
 
-// checked group info
-static
-const fix_group_info* safe_group_info(const fix_group* const group, unsigned tag)
-{
-	const fix_group_info* const info = group->info->get_group_info(tag);
-
-	if(info)
-		return info;
-
-	group->error->code = FE_INVALID_PARSER_STATE;	// invalid spec., must never happen
-	return NULL;
-}
-
 // read tag string and the next tag
 static
 void read_string_and_get_next(fix_parser* const parser, tag_value* const result)
 {
 	if(result)
 	{
-		if(fix_string_is_empty(result->value = read_string(parser)))
+		const fix_string value = read_string(parser);
+
+		if(fix_string_is_empty(value))
 			parser->result.error.code = FE_EMPTY_VALUE;
 		else
+		{
+			*result = make_tag_value(parser, value);
 			next_tag(parser);
+		}
+	}
+}
+
+// eager conversion of a string value by its type into the given side slot
+static
+fix_error convert_value(fix_value_type type, const fix_string value, converted_value* const result)
+{
+	switch(type)
+	{
+		case FIX_VALUE_LONG:
+			return convert_fix_value_to_long(value, &result->l);
+		case FIX_VALUE_DOUBLE:
+			return convert_fix_value_to_double(value, &result->d);
+		case FIX_VALUE_UTC_TIMESTAMP:
+		{
+			utc_timestamp ts;
+			const fix_error err = convert_fix_value_to_utc_timestamp(value, &ts);
+
+			if(err == FE_OK)
+				result->ts = (packed_timestamp){ ts.year, ts.month, ts.day, ts.hour, ts.minute, ts.second, ts.millisecond };
+
+			return err;
+		}
+		default:
+			return FE_OK;
+	}
+}
+
+// read tag string, convert it into the side slot of the tag, and read the next tag
+static
+void read_converted_string_and_get_next(fix_parser* const parser, fix_group* const group, unsigned ti, fix_value_type type)
+{
+	tag_value* const result = tag_value_checked_ptr(parser, group, ti);
+
+	if(!result)
+		return;
+
+	const fix_string value = read_string(parser);
+
+	if(fix_string_is_empty(value))
+	{
+		parser->result.error.code = FE_EMPTY_VALUE;
+		return;
+	}
+
+	const fix_error err = convert_value(type, value, &group->converted[group->node_base + TAG_INDEX(ti)]);
+
+	if(err != FE_OK)
+	{
+		set_error_ctx(&parser->result.error, err, parser->result.error.tag, value);
+		return;
 	}
+
+	*result = make_tag_value(parser, value);
+	next_tag(parser);
 }
 
 // read binary value and the next tag
@@ -357,120 +466,264 @@ void read_binary_and_get_next(fix_parser* const parser, const unsigned bin_tag,
 	}
 
 	// store the string
-	result->value = res;
+	*result = make_tag_value(parser, res);
 	parser->frame.begin = res.end + 1;
 
 	// next tag
 	next_tag(parser);
 }
 
-// forward declaration
-static
-void read_group_and_get_next(fix_parser* const parser, const fix_group_info* const info, tag_value* const result);
+// projection check; binary values are selected by their data tag
+static inline
+bool is_projected(const fix_projection* const proj, unsigned tag, unsigned ti)
+{
+	if(TAG_TYPE(ti) == TAG_LENGTH)
+		tag = TAG_MAIN(ti);
 
-// tag processor
-// returns false on error or unknown tag
+	return tag < proj->num_tags && (proj->bits[tag >> 6] & ((uint64_t)1 << (tag & 63)));
+}
+
+// value reader for all the tag types except groups; the value is stored in the group, or skipped if there is no group
 static
-bool process_tag_and_get_next(fix_parser* const parser, fix_group* const group)
+void read_value_and_get_next(fix_parser* const parser, fix_group* const group, unsigned ti)
 {
-	const unsigned 	tag = parser->result.error.tag,
-					ti = group->info->get_tag_info(tag);
-
-	if(ti == NONE)
-		return false;	// maybe the tag is not from this group
+	tag_value skipped = { 0, 0 };
 
 	switch(TAG_TYPE(ti))
 	{
 		case TAG_STRING:
-			read_string_and_get_next(parser, tag_value_checked_ptr(group, ti));
+		{
+			const fix_value_type type = group && group->converted ? value_type(group->info, TAG_INDEX(ti)) : FIX_VALUE_STRING;
+
+			if(type == FIX_VALUE_LONG || type == FIX_VALUE_DOUBLE || type == FIX_VALUE_UTC_TIMESTAMP)
+				read_converted_string_and_get_next(parser, group, ti, type);
+			else
+				read_string_and_get_next(parser, group ? tag_value_checked_ptr(parser, group, ti) : &skipped);
+
 			break;
+		}
 		case TAG_LENGTH:
-			read_binary_and_get_next(parser, TAG_MAIN(ti), binary_tag_value_checked_ptr(group, ti));
+			read_binary_and_get_next(parser, TAG_MAIN(ti), group ? binary_tag_value_checked_ptr(parser, group, ti) : &skipped);
 			break;
 		case TAG_BINARY:
-			parser->result.error.code = FE_INVALID_TAG_ORDER;
-			return false;
+			if(parser->validation == FIX_VALIDATION_STRICT)
+				parser->result.error.code = FE_INVALID_TAG_ORDER;
+			else	// no length tag, read as a string
+				read_string_and_get_next(parser, group ? tag_value_checked_ptr(parser, group, ti) : &skipped);
+
+			break;
 		case TAG_GROUP:
-			read_group_and_get_next(parser,
-									safe_group_info(group, tag),
-									tag_value_checked_ptr(group, ti));
+			parser->result.error.code = FE_INVALID_PARSER_STATE;	// must never happen
 			break;
 	}
-
-	return parser->result.error.code == FE_OK;
 }
 
-// group reader
+// starts the repeating group of the current tag in the given frame: reads the number of nodes and the first tag;
+// the group is stored in the parent group, or skipped if there is no parent or the tag is not projected
+// returns false on error
 static
-void read_group_and_get_next(fix_parser* const parser, const fix_group_info* const info, tag_value* const result)
+bool open_group(fix_parser* const parser, group_frame* const frame, const fix_group_info* const parent_info,
+				fix_group* const parent, unsigned tag, unsigned ti)
 {
-	if(!info || !result)
-		return;
+	// group info
+	const fix_group_info* const info = parent_info->get_group_info(tag);
+
+	if(!info)
+	{
+		parser->result.error.code = FE_INVALID_PARSER_STATE;	// invalid spec., must never happen
+		return false;
+	}
+
+	// group slot
+	tag_value* result = NULL;
+
+	if(parent && (!parser->projection || is_projected(parser->projection, tag, ti))
+	   && !(result = tag_value_checked_ptr(parser, parent, ti)))
+		return false;
 
 	// read number of nodes
 	const unsigned len = read_uint_value(parser);
 
 	if(len == 0)
-		return;	// something has gone wrong
+		return false;	// something has gone wrong
 
-	if(len > MAX_GROUP_SIZE)
+	if(len > parser->limits.max_group_size)
 	{
 		parser->result.error.code = FE_INVALID_VALUE;
-		return;
+		return false;
 	}
 
+	// length tag and context are saved for error reporting; the node count of a skipped group
+	// is only checked with strict validation
+	*frame = (group_frame){ info, NULL, result || parser->validation == FIX_VALIDATION_STRICT ? len : UINT_MAX, 0,
+							parser->result.error.tag, parser->result.error.context };
+
 	// new group
-	fix_group* const group = alloc_group(parser, info, len);
+	if(result && !(frame->group = alloc_group(parser, info, len, result)))
+		return false;
 
-	if(!group)
-		return;
+	// match first tag in group; it delimits the nodes at every validation level
+	return match_next_tag(parser, info->first_tag);
+}
 
-	// save length tag and context for error reporting
-	const unsigned len_tag = group->error->tag;
-	const fix_string len_ctx = group->error->context;
+// resets the node iterators of the groups still open on an error
+static
+void reset_open_groups(group_frame* const stack, unsigned depth)
+{
+	while(depth > 0)
+		if(stack[--depth].group)
+			stack[depth].group->node_base = 0;
+}
 
-	// match first tag in group
-	if(!match_next_tag(parser, info->first_tag))
+// group reader: reads or skips the repeating group of the current tag, with all the groups nested in it,
+// using the parser's stack of group frames instead of recursion
+static
+void read_group_and_get_next(fix_parser* const parser, const fix_group_info* const parent_info,
+							 fix_group* const parent, unsigned tag, unsigned ti)
+{
+	group_frame* const stack = parser->group_stack;
+	unsigned depth = 0;
+
+	if(!open_group(parser, &stack[depth++], parent_info, parent, tag, ti))
 		return;
 
-	// read the group
-	while(process_tag_and_get_next(parser, group))
+	do
 	{
-		if(group->error->tag == info->first_tag)	// starting new group node
+		group_frame* const top = &stack[depth - 1];
+
+		tag = parser->result.error.tag;
+		ti = lookup_tag_info(top->info, tag);
+
+		if(ti == NONE)	// end of group
 		{
-			const unsigned n = info->node_size;
+			if(top->group)
+				top->group->node_base = 0;	// reset node iterator
 
-			group->node_base += n;
+			--depth;
+			continue;
+		}
 
-			if(group->node_base >= n * len)	// too many nodes
+		if(tag == top->info->first_tag)	// starting new group node
+		{
+			if(++top->num_nodes > top->len)	// too many nodes
 			{
-				set_error_ctx(group->error, FE_INVALID_GROUP_COUNT, len_tag, len_ctx);
-				break;
+				if(parser->validation == FIX_VALIDATION_STRICT)
+				{
+					set_error_ctx(&parser->result.error, FE_INVALID_GROUP_COUNT, top->len_tag, top->len_ctx);
+					break;
+				}
+
+				// drop the extra nodes
+				top->group->node_base = 0;
+				top->group = NULL;
+				top->len = UINT_MAX;
 			}
+			else if(top->group && top->num_nodes > 1)
+				top->group->node_base += top->info->node_size;
+		}
+
+		if(TAG_TYPE(ti) != TAG_GROUP)
+		{
+			read_value_and_get_next(parser,
+									top->group && (!parser->projection || is_projected(parser->projection, tag, ti))
+									? top->group : NULL,
+									ti);
+
+			if(parser->result.error.code != FE_OK)
+				break;
+		}
+		else if(depth < parser->limits.max_group_depth)
+		{
+			if(!open_group(parser, &stack[depth], top->info, top->group, tag, ti))
+				break;
+
+			++depth;
+		}
+		else	// nesting too deep, the context names the limit
+		{
+			set_error_ctx(&parser->result.error, FE_OTHER, tag, CONST_LIT("max_group_depth"));
+			break;
 		}
+	} while(depth > 0);
+
+	// early exit on error: the groups read so far are still accessible
+	reset_open_groups(stack, depth);
+}
+
+// tag processor
+// returns false on error or unknown tag
+static
+bool process_tag_and_get_next(fix_parser* const parser, fix_group* const group)
+{
+	const unsigned 	tag = parser->result.error.tag,
+					ti = lookup_tag_info(group->info, tag);
+
+	if(ti == NONE)
+	{
+		// relaxed validation: unknown tags are skipped at the message level
+		if(tag == 0 || group != parser->result.root || parser->validation == FIX_VALIDATION_STRICT)
+			return false;	// maybe the tag is not from this group
+
+		tag_value value = { 0, 0 };
+
+		read_string_and_get_next(parser, &value);
+		return parser->result.error.code == FE_OK;
 	}
 
-	// reset node iterator
-	group->node_base = 0;
+	if(TAG_TYPE(ti) == TAG_GROUP)
+		read_group_and_get_next(parser, group->info, group, tag, ti);
+	else
+		read_value_and_get_next(parser,
+								!parser->projection || is_projected(parser->projection, tag, ti) ? group : NULL,
+								ti);
 
-	// store the group
-	result->group = group;
+	return parser->result.error.code == FE_OK;
 }
 
-// parser entry point
+// final checks after the message body is parsed
+// returns false on fatal error
 static
-const fix_parser_result* run(fix_parser* const parser)
+bool finish_message(fix_parser* const parser)
 {
-	// scanner
-	if(!extract_next_message(parser))
-		return NULL;
+	fix_error_details* const details = &parser->result.error;
+
+	if(details->code > FE_OTHER)	// fatal error
+		return false;
+
+	if(details->code == FE_OK && details->tag != 0)
+		details->code = FE_UNEXPECTED_TAG;
+
+	return true;
+}
 
+// projection of the given message type, if any
+static
+const fix_projection* find_projection(const fix_parser* const parser, int msg_type_code)
+{
+	for(const fix_projection* p = parser->projections; p < parser->projections + parser->num_projections; ++p)
+		if(p->msg_type_code == msg_type_code)
+			return p;
+
+	return NULL;
+}
+
+// parser for the message extracted by the scanner
+static
+const fix_parser_result* parse_message_body(fix_parser* const parser)
+{
 	// check message result and begin string
 	fix_parser_result* const result = &parser->result;
 
+	// drop the suspended state of the previous message
+	if(result->root)
+		result->root->lazy = NULL;
+
 	if(result->error.code != FE_OK)
 		return result;
 
+	// tag limit
+	parser->tags_left = parser->limits.max_tags ? parser->limits.max_tags : UINT_MAX;
+
 	// message type
 	if(!match_next_tag(parser, 35))
 		return result;
@@ -478,7 +731,7 @@ const fix_parser_result* run(fix_parser* const parser)
 	const fix_string mt = result->error.msg_type = read_string(parser);
 
 	// message info
-	const fix_message_info* const pmi = parser->parser_table(mt);
+	const fix_message_info* const pmi = parser->spec->parser_table(mt);
 
 	if(!pmi)
 	{
@@ -489,25 +742,73 @@ const fix_parser_result* run(fix_parser* const parser)
 	// store message type code
 	result->msg_type_code = pmi->message_type;
 
+	// tag projection
+	parser->projection = find_projection(parser, pmi->message_type);
+
 	// set-up root group
 	if(!prepare_root_group(parser, &pmi->root))
 		return NULL;
 
 	// read the rest
 	if(next_tag(parser) != 0)
+	{
+		if(parser->flags & FIX_LAZY)
+		{
+			// suspend until the first tag access
+			parser->message_state = result->error;
+			result->root->lazy = parser;
+			set_error_ctx(&result->error, FE_OK, 0, EMPTY_STR);
+			return result;
+		}
+
 		while(process_tag_and_get_next(parser, result->root));
+	}
 
-	// check for errors
-	if(result->error.code > FE_OTHER)	// fatal error
-		return NULL;
+	return finish_message(parser) ? result : NULL;
+}
+
+static
+const fix_parser_result* parse_message(fix_parser* const parser)
+{
+	const fix_parser_result* const result = parse_message_body(parser);
 
-	if(result->error.code == FE_OK && result->error.tag != 0)
-		result->error.code = FE_UNEXPECTED_TAG;
+	// keep the final error details for validate_fix_message()
+	if(result && !(result->root && result->root->lazy))
+		parser->message_state = result->error;
 
-	// all done
 	return result;
 }
 
+// lazy mode: resume parsing the root group until the given tag value is set or the message ends
+static
+fix_error resume_message(fix_parser* const parser, const tag_value* const value)
+{
+	fix_parser_result* const result = &parser->result;
+
+	result->error = parser->message_state;
+
+	while(!value || value_length(value, parser->stamp) == 0)
+	{
+		if(!process_tag_and_get_next(parser, result->root))
+		{
+			result->root->lazy = NULL;
+			finish_message(parser);
+			parser->message_state = result->error;
+			return result->error.code;
+		}
+	}
+
+	parser->message_state = result->error;
+	return FE_OK;
+}
+
+// parser entry point
+static
+const fix_parser_result* run(fix_parser* const parser)
+{
+	return extract_next_message(parser) ? parse_message(parser) : NULL;
+}
+
 // parser check
 static inline
 bool is_usable_parser(const fix_parser* const parser)
@@ -516,51 +817,143 @@ bool is_usable_parser(const fix_parser* const parser)
 }
 
 // parser interface implementation -------------------------------------------------------------------------------
-// constructor
+// standard allocator
+static
+void* std_malloc(void* ctx UNUSED, size_t size)
+{
+	return malloc(size);
+}
+
+static
+void* std_realloc(void* ctx UNUSED, void* p, size_t size)
+{
+	return realloc(p, size);
+}
+
+static
+void std_free(void* ctx UNUSED, void* p)
+{
+	free(p);
+}
+
+static const fix_allocator std_allocator = { std_malloc, std_realloc, std_free, NULL };
+
+// constructors
 fix_parser* create_fix_parser(const fix_message_info* (*parser_table)(const fix_string),
 							  const fix_string fix_version)
+{
+	return create_fix_parser_ex(parser_table, fix_version, NULL);
+}
+
+// specification set-up
+static
+bool init_spec(fix_parser_spec* const spec, const fix_message_info* (*parser_table)(const fix_string),
+			   const fix_string fix_version)
 {
 	if(!parser_table
 		|| fix_string_length(fix_version) < sizeof("FIX.4.4") - 1
 		|| fix_string_length(fix_version) > sizeof("FIXT.1.1") - 1
 		|| fix_version.begin[0] != 'F' || fix_version.begin[1] != 'I' || fix_version.begin[2] != 'X' || fix_version.begin[3] != '.')
 	{
-		errno = EINVAL;
-		return NULL;
+		return false;
 	}
 
-	fix_parser* const parser = NEW(fix_parser);
+	// parser table
+	spec->parser_table = parser_table;
 
-	if(!parser)
-		return NULL;
-
-	// initialise scanner and root
-	if(!init_scanner(parser) || !prepare_root_group(parser, NULL))
-	{
-		free_fix_parser(parser);
-		errno = ENOMEM;
-		return NULL;
-	}
-
-	// parser table
-	parser->parser_table = parser_table;
+	// SIMD kernels
+	spec->simd_level = FIX_SIMD_AUTO;
+	spec->kernels = select_kernels(&spec->simd_level);
 
 	// FIX begin string (e.g. "8=FIXT.1.1|9=")
-	char* p = parser->header;
+	char* p = spec->header;
 
 	*p++ = '8';
 	*p++ = '=';
 
-	unsigned char checksum = '8' + '=' + SOH + '9' + '=';
+	memcpy(p, fix_version.begin, fix_string_length(fix_version));
+	p += fix_string_length(fix_version);
+
+	unsigned char checksum = SOH + '9' + '=';
 
-	for(const char* s = fix_version.begin; s < fix_version.end; )
-		checksum += (*p++ = *s++);
+	for(const char* s = spec->header; s < p; ++s)
+		checksum += *s;
 
-	parser->header_checksum = checksum;
+	spec->header_checksum = checksum;
 	*p++ = SOH;
 	*p++ = '9';
 	*p++ = '=';
-	parser->header_len = p - parser->header;
+	spec->header_len = p - spec->header;
+	return true;
+}
+
+fix_parser* create_fix_parser_ex(const fix_message_info* (*parser_table)(const fix_string),
+								 const fix_string fix_version,
+								 const fix_allocator* allocator)
+{
+	fix_parser_spec spec;
+
+	if(!init_spec(&spec, parser_table, fix_version))
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	// the parser keeps its own copy of the specification
+	fix_parser* const parser = create_fix_parser_from_spec(&spec, allocator);
+
+	if(parser)
+	{
+		parser->own_spec = spec;
+		parser->spec = &parser->own_spec;
+	}
+
+	return parser;
+}
+
+fix_parser* create_fix_parser_from_spec(const fix_parser_spec* const spec, const fix_allocator* allocator)
+{
+	if(!spec)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if(!allocator)
+		allocator = &std_allocator;
+	else if(!allocator->malloc || !allocator->realloc || !allocator->free)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	fix_parser* const parser = ALLOC(allocator, sizeof(fix_parser));
+
+	if(!parser)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	memset(parser, 0, sizeof(fix_parser));
+	parser->allocator = *allocator;
+
+	// initialise limits with group stack, scanner and root
+	static const fix_parser_limits default_limits = { DEFAULT_MESSAGE_LENGTH, DEFAULT_GROUP_SIZE, DEFAULT_GROUP_DEPTH, 0 };
+
+	if(!set_fix_parser_limits(parser, &default_limits) || !init_scanner(parser) || !prepare_root_group(parser, NULL))
+	{
+		free_fix_parser(parser);
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	// specification
+	parser->spec = spec;
+
+	// SIMD kernels, as selected for the specification
+	parser->simd_level = spec->simd_level;
+	parser->kernels = spec->kernels;
 
 	// error code
 	parser->result.error.code = FE_OK;
@@ -572,29 +965,309 @@ void free_fix_parser(fix_parser* const parser)
 {
 	if(parser)
 	{
+		const fix_allocator allocator = parser->allocator;
+
 		if(parser->body)
-			free(parser->body);
+			FREE(&allocator, parser->body);
+
+		if(parser->replay)
+			FREE(&allocator, parser->replay);
+
+		if(parser->result.root)
+			FREE(&allocator, parser->result.root);
+
+		free_arena(&allocator, &parser->arena);
+
+		if(parser->group_stack)
+			FREE(&allocator, parser->group_stack);
+
+		for(unsigned i = 0; i < parser->num_projections; ++i)
+			FREE(&allocator, parser->projections[i].bits);
+
+		if(parser->projections)
+			FREE(&allocator, parser->projections);
+
+		for(batch_slot* slot = parser->batch; slot < parser->batch + parser->batch_capacity; ++slot)
+		{
+			if(slot->body)
+				FREE(&allocator, slot->body);
+
+			if(slot->result.root)
+				FREE(&allocator, slot->result.root);
+
+			free_arena(&allocator, &slot->arena);
+		}
+
+		if(parser->batch)
+			FREE(&allocator, parser->batch);
+
+		FREE(&allocator, parser);
+	}
+}
+
+// compiled specification
+fix_parser_spec* create_fix_parser_spec(const fix_message_info* (*parser_table)(const fix_string),
+										const fix_string fix_version)
+{
+	fix_parser_spec spec;
+
+	if(!init_spec(&spec, parser_table, fix_version))
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	fix_parser_spec* const p = malloc(sizeof(fix_parser_spec));
+
+	if(!p)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	*p = spec;
+	return p;
+}
+
+void free_fix_parser_spec(fix_parser_spec* const spec)
+{
+	free(spec);
+}
+
+// reset
+void reset_fix_parser(fix_parser* const parser)
+{
+	if(parser)
+	{
+		// drop the suspended state of the last message
+		if(parser->result.root)
+			parser->result.root->lazy = NULL;
+
+		// scanner, message and error state, as in a new parser
+		memset(&parser->state, 0, sizeof(scanner_state));
+		parser->frame = (fix_string){ NULL, NULL };
+		parser->raw = NULL;
+		parser->body_length = 0;
+		parser->message_state = (fix_error_details){ FE_OK, 0, EMPTY_STR, EMPTY_STR };
+		parser->projection = NULL;
+		parser->checksum_counter = 0;
+		parser->result.error = (fix_error_details){ FE_OK, 0, EMPTY_STR, EMPTY_STR };
+		parser->result.msg_type_code = 0;
+
+		// input statistics; the memory ones stay, as the memory is kept
+		parser->stats.discarded_bytes = parser->stats.num_resyncs = 0;
+
+		// groups of the last message and of the batch, keeping the memory
+		reset_arena(&parser->arena);
+		release_fix_message_batch(parser);
+	}
+}
+
+// parser flags
+unsigned get_fix_parser_flags(const fix_parser* const parser)
+{
+	return parser ? parser->flags : 0;
+}
+
+void set_fix_parser_flags(fix_parser* const parser, unsigned flags)
+{
+	if(parser)
+		parser->flags = flags;
+}
+
+// SIMD kernels
+fix_simd_level get_fix_parser_simd_level(const fix_parser* const parser)
+{
+	return parser ? parser->simd_level : FIX_SIMD_NONE;
+}
+
+bool set_fix_parser_simd_level(fix_parser* const parser, fix_simd_level level)
+{
+	if(!parser)
+		return false;
+
+	const fix_kernels* const kernels = select_kernels(&level);
+
+	if(!kernels)
+		return false;
+
+	parser->kernels = kernels;
+	parser->simd_level = level;
+	return true;
+}
+
+// checksum policy
+fix_checksum_policy get_fix_parser_checksum_policy(const fix_parser* const parser)
+{
+	return parser ? parser->checksum_policy : FIX_CHECKSUM_ALWAYS;
+}
+
+bool set_fix_parser_checksum_policy(fix_parser* const parser, fix_checksum_policy policy, unsigned sample_rate)
+{
+	if(!parser || (unsigned)policy > FIX_CHECKSUM_DEFERRED || (policy == FIX_CHECKSUM_SAMPLED && sample_rate == 0))
+		return false;
+
+	parser->checksum_policy = policy;
+	parser->checksum_sample_rate = sample_rate;
+	parser->checksum_counter = 0;
+	return true;
+}
+
+// parser limits
+fix_parser_limits get_fix_parser_limits(const fix_parser* const parser)
+{
+	return parser ? parser->limits : (fix_parser_limits){ 0, 0, 0, 0 };
+}
+
+bool set_fix_parser_limits(fix_parser* const parser, const fix_parser_limits* const limits)
+{
+	if(!parser || !limits
+	   || limits->max_message_length < sizeof("35=0|49=X|56=Y|34=1|") - 1 || limits->max_message_length > MAX_MESSAGE_LENGTH
+	   || limits->max_group_size == 0 || limits->max_group_size > MAX_GROUP_SIZE
+	   || limits->max_group_depth == 0 || limits->max_group_depth > MAX_GROUP_DEPTH)
+		return false;
+
+	// group stack of the new depth; the message buffers are sized from the new length
+	// as they get (re)allocated
+	group_frame* const stack = REALLOC(&parser->allocator, parser->group_stack, limits->max_group_depth * sizeof(group_frame));
+
+	if(!stack)
+		return false;
+
+	parser->group_stack = stack;
+	parser->limits = *limits;
+	return true;
+}
+
+// validation level
+fix_validation_level get_fix_parser_validation_level(const fix_parser* const parser)
+{
+	return parser ? parser->validation : FIX_VALIDATION_STRICT;
+}
+
+bool set_fix_parser_validation_level(fix_parser* const parser, fix_validation_level level)
+{
+	if(!parser || (unsigned)level > FIX_VALIDATION_NONE)
+		return false;
+
+	parser->validation = level;
+	return true;
+}
+
+// tag projection
+bool set_fix_message_projection(fix_parser* const parser, int msg_type_code, const unsigned* tags, unsigned num_tags)
+{
+	if(!parser || (num_tags > 0 && !tags))
+		return false;
+
+	fix_projection* p = (fix_projection*)find_projection(parser, msg_type_code);
+
+	// removal
+	if(num_tags == 0)
+	{
+		if(p)
+		{
+			FREE(&parser->allocator, p->bits);
+			*p = parser->projections[--parser->num_projections];
+			parser->projection = find_projection(parser, parser->result.msg_type_code);
+		}
+
+		return true;
+	}
+
+	// bit set, sized by the largest tag
+	unsigned max_tag = 0;
+
+	for(unsigned i = 0; i < num_tags; ++i)
+	{
+		if(tags[i] > MAX_PROJECTION_TAG)
+			return false;
+
+		if(tags[i] > max_tag)
+			max_tag = tags[i];
+	}
+
+	const unsigned n = max_tag / 64 + 1;
+	uint64_t* const bits = ALLOC(&parser->allocator, n * sizeof(uint64_t));
+
+	if(!bits)
+		return false;
+
+	memset(bits, 0, n * sizeof(uint64_t));
+
+	for(unsigned i = 0; i < num_tags; ++i)
+		bits[tags[i] >> 6] |= (uint64_t)1 << (tags[i] & 63);
+
+	// new entry
+	if(!p)
+	{
+		p = REALLOC(&parser->allocator, parser->projections, (parser->num_projections + 1) * sizeof(fix_projection));
+
+		if(!p)
+		{
+			FREE(&parser->allocator, bits);
+			return false;
+		}
 
-		free_groups(parser->result.root);
-		free(parser);
+		parser->projections = p;
+		p += parser->num_projections++;
 	}
+	else
+		FREE(&parser->allocator, p->bits);
+
+	*p = (fix_projection){ msg_type_code, n * 64, bits };
+	parser->projection = find_projection(parser, parser->result.msg_type_code);
+	return true;
 }
 
 // message iterators
+static
+bool has_unprocessed_input(fix_parser* const parser)
+{
+	const scanner_state* const state = &parser->state;
+
+	if(state->src == state->end && !state->replay && state->iov_count == 0)
+		return false;
+
+	set_fatal_error(parser, FE_INVALID_PARSER_STATE);
+	return true;
+}
+
+bool set_scanner_input(fix_parser* const parser, const void* bytes, unsigned num_bytes)
+{
+	if(!is_usable_parser(parser) || has_unprocessed_input(parser))
+		return false;
+
+	// store pointers
+	parser->state.src = bytes;
+	parser->state.end = bytes + num_bytes;
+	return true;
+}
+
 const fix_parser_result* get_first_fix_message(fix_parser* const parser, const void* bytes, unsigned num_bytes)
 {
-	if(!is_usable_parser(parser))
+	return set_scanner_input(parser, bytes, num_bytes) ? run(parser) : NULL;
+}
+
+const fix_parser_result* get_first_fix_message_iov(fix_parser* const parser, const struct iovec* iov, unsigned iov_count)
+{
+	if(!is_usable_parser(parser) || has_unprocessed_input(parser))
 		return NULL;
 
-	if(parser->state.src != parser->state.end)	// unprocessed input
+	if(iov_count == 0)
+		return NULL;
+
+	if(!iov)
 	{
 		set_fatal_error(parser, FE_INVALID_PARSER_STATE);
 		return NULL;
 	}
 
 	// store pointers
-	parser->state.src = bytes;
-	parser->state.end = bytes + num_bytes;
+	parser->state.src = iov->iov_base;
+	parser->state.end = parser->state.src + iov->iov_len;
+	parser->state.iov = iov + 1;
+	parser->state.iov_count = iov_count - 1;
 
 	// run the parser
 	return run(parser);
@@ -605,14 +1278,201 @@ const fix_parser_result* get_next_fix_message(fix_parser* const parser)
 	return is_usable_parser(parser) ? run(parser) : NULL;
 }
 
+// message batch
+// parse the rest of the message, if suspended in lazy mode
+// returns false on fatal error
+static
+bool complete_message(fix_parser* const parser)
+{
+	if(parser->result.root->lazy)
+		resume_message(parser, NULL);
+
+	return parser->result.error.code <= FE_OTHER;
+}
+
+static
+bool reserve_batch(fix_parser* const parser, unsigned n)
+{
+	if(n <= parser->batch_capacity)
+		return true;
+
+	batch_slot* const p = REALLOC(&parser->allocator, parser->batch, n * sizeof(batch_slot));
+
+	if(!p)
+	{
+		set_fatal_error(parser, FE_OUT_OF_MEMORY);
+		return false;
+	}
+
+	memset(p + parser->batch_capacity, 0, (n - parser->batch_capacity) * sizeof(batch_slot));
+	parser->batch = p;
+	parser->batch_capacity = n;
+	return true;
+}
+
+// update the groups of a message moved to or from a batch slot
+static
+void move_groups(fix_group* const root, fix_error_details* const error, const group_arena* const arena)
+{
+	if(root)
+	{
+		root->error = error;
+		root->arena = arena;
+	}
+
+	for(unsigned i = 0; i < arena->num_groups; ++i)
+	{
+		arena->groups[i]->error = error;
+		arena->groups[i]->arena = arena;
+	}
+}
+
+// move the current message to the given slot, replacing it with the slot's spare buffers
+static
+bool move_to_slot(fix_parser* const parser, batch_slot* const slot)
+{
+	// message buffer, if the message has been copied to it
+	if(parser->raw == parser->body)
+	{
+		if(!slot->body)
+		{
+			const unsigned n = initial_body_size(parser);
+
+			if(!(slot->body = ALLOC(&parser->allocator, n)))
+			{
+				set_fatal_error(parser, FE_OUT_OF_MEMORY);
+				return false;
+			}
+
+			slot->body_capacity = n;
+		}
+
+		char* const body = parser->body;
+		const unsigned body_capacity = parser->body_capacity;
+
+		parser->body = slot->body;
+		parser->body_capacity = slot->body_capacity;
+		slot->body = body;
+		slot->body_capacity = body_capacity;
+	}
+
+	// result and groups
+	const fix_parser_result result = parser->result;
+	const unsigned root_capacity = parser->root_capacity;
+	const bool root_converted = parser->root_converted;
+	const group_arena arena = parser->arena;
+
+	parser->result = slot->result;
+	parser->root_capacity = slot->root_capacity;
+	parser->root_converted = slot->root_converted;
+	parser->arena = slot->arena;
+	slot->result = result;
+	slot->root_capacity = root_capacity;
+	slot->root_converted = root_converted;
+	slot->arena = arena;
+
+	// point the groups to their new error details and arena
+	move_groups(slot->result.root, &slot->result.error, &slot->arena);
+	move_groups(parser->result.root, &parser->result.error, &parser->arena);
+
+	// clear the parser's error, as it now comes from an older message
+	parser->result.error = (fix_error_details){ FE_OK, 0, EMPTY_STR, EMPTY_STR };
+	parser->body_length = 0;
+	return true;
+}
+
+unsigned get_next_fix_message_batch(fix_parser* const parser, const fix_parser_result** const results, unsigned max_results)
+{
+	if(!is_usable_parser(parser) || !results || !reserve_batch(parser, max_results))
+		return 0;
+
+	unsigned n = 0;
+
+	while(n < max_results && run(parser) && complete_message(parser) && move_to_slot(parser, &parser->batch[n]))
+	{
+		results[n] = &parser->batch[n].result;
+		++n;
+	}
+
+	return n;
+}
+
+unsigned get_first_fix_message_batch(fix_parser* const parser, const void* bytes, unsigned num_bytes,
+									 const fix_parser_result** const results, unsigned max_results)
+{
+	return set_scanner_input(parser, bytes, num_bytes) ? get_next_fix_message_batch(parser, results, max_results) : 0;
+}
+
+void release_fix_message_batch(fix_parser* const parser)
+{
+	if(parser)
+	{
+		for(batch_slot* slot = parser->batch; slot < parser->batch + parser->batch_capacity; ++slot)
+			reset_arena(&slot->arena);
+	}
+}
+
+// framed message
+const fix_parser_result* get_fix_message_from_frame(fix_parser* const parser, const void* bytes,
+													const fix_frame* const frame)
+{
+	if(!is_usable_parser(parser))
+		return NULL;
+
+	// a frame not matching the bytes, or a streamed message in progress, is a caller error
+	if(!bytes || !frame || has_partial_message(parser)
+	   || !extract_framed_message(parser, (const char*)bytes + frame->offset, frame))
+	{
+		set_error(&parser->result.error, FE_OTHER, 0);
+		return NULL;
+	}
+
+	return parse_message(parser);
+}
+
+// parser statistics
+const fix_parser_stats* get_fix_parser_stats(const fix_parser* const parser)
+{
+	return parser ? &parser->stats : NULL;
+}
+
 // raw message access
 fix_string get_raw_fix_message(const fix_parser* parser)
 {
 	return is_usable_parser(parser) && parser->body_length > 0
-			? (fix_string){ parser->body, parser->body + parser->body_length }
+			? (fix_string){ parser->raw, parser->raw + parser->body_length }
 			: EMPTY_STR;
 }
 
+// checksum verification of the current message
+fix_error verify_fix_message_checksum(const fix_parser* const parser)
+{
+	return is_usable_parser(parser) && parser->body_length > 0 ? verify_message_checksum(parser) : FE_OTHER;
+}
+
+// complete parsing of the current message in lazy mode
+fix_error validate_fix_message(fix_parser* const parser)
+{
+	if(!parser || parser->result.error.code > FE_OTHER || !parser->result.root)
+		return FE_OTHER;
+
+	if(parser->result.root->lazy)
+		resume_message(parser, NULL);
+
+	// deferred checksum
+	if(parser->message_state.code == FE_OK && parser->checksum_policy == FIX_CHECKSUM_DEFERRED
+	   && parser->validation != FIX_VALIDATION_NONE && parser->body_length > 0
+	   && verify_message_checksum(parser) != FE_OK)
+	{
+		const char* const end = parser->raw + parser->body_length;
+
+		set_error_ctx(&parser->message_state, FE_INVALID_VALUE, 10, (fix_string){ end - (sizeof("10=123|") - 1), end - 1 });
+	}
+
+	parser->result.error = parser->message_state;
+	return parser->result.error.code;
+}
+
 // parser error
 const fix_error_details* get_fix_parser_error_details(const fix_parser* const parser)
 {
@@ -664,13 +1524,14 @@ fix_error set_group_error(const fix_group* const group, unsigned tag, fix_error
 	return err;
 }
 
-// tag as string
-fix_error get_fix_tag_as_string(const fix_group* const group, unsigned tag, fix_string* const result)
+// tag value, and its converted value, if any
+fix_error get_tag_value(const fix_group* const group, unsigned tag, fix_value_type type,
+						fix_string* const result, const converted_value** const converted)
 {
 	if(!group || group->node_base == NONE)
 		return FE_OTHER;
 
-	const unsigned ti = group->info->get_tag_info(tag);
+	const unsigned ti = lookup_tag_info(group->info, tag);
 
 	if(ti == NONE)
 		return set_group_error(group, tag, FE_UNEXPECTED_TAG);
@@ -686,25 +1547,47 @@ fix_error get_fix_tag_as_string(const fix_group* const group, unsigned tag, fix_
 			return set_group_error(group, tag, FE_INCORRECT_VALUE_FORMAT);
 	}
 
-	const fix_string value = group->tags[group->node_base + TAG_INDEX(ti)].value;
+	const tag_value* const pv = &group->tags[group->node_base + TAG_INDEX(ti)];
 
-	if(fix_string_is_empty(value))
+	if(group->lazy && value_length(pv, group->stamp) == 0)
+	{
+		const fix_error err = resume_message(group->lazy, pv);
+
+		if(err != FE_OK)
+			return err;
+	}
+
+	const unsigned len = value_length(pv, group->stamp);
+
+	if(len == 0)
 		return set_group_error(group, tag, FE_REQUIRED_TAG_MISSING);
 
+	const fix_string value = { group->base + pv->offset, group->base + pv->offset + len };
+
 	if(result)
 		*result = value;
 
+	if(converted)
+		*converted = group->converted && type != FIX_VALUE_STRING && value_type(group->info, TAG_INDEX(ti)) == type
+					 ? &group->converted[group->node_base + TAG_INDEX(ti)] : NULL;
+
 	set_error_ctx(group->error, FE_OK, tag, value);
 	return FE_OK;
 }
 
+// tag as string
+fix_error get_fix_tag_as_string(const fix_group* const group, unsigned tag, fix_string* const result)
+{
+	return get_tag_value(group, tag, FIX_VALUE_STRING, result, NULL);
+}
+
 // tag as group
 fix_error get_fix_tag_as_group(const fix_group* const group, unsigned tag, fix_group** const result)
 {
 	if(!group || group->node_base == NONE)
 		return FE_OTHER;
 
-	const unsigned ti = group->info->get_tag_info(tag);
+	const unsigned ti = lookup_tag_info(group->info, tag);
 
 	if(ti == NONE)
 		return set_group_error(group, tag, FE_UNEXPECTED_TAG);
@@ -720,14 +1603,76 @@ fix_error get_fix_tag_as_group(const fix_group* const group, unsigned tag, fix_g
 			return set_group_error(group, tag, FE_UNEXPECTED_TAG);
 	}
 
-	fix_group* const g = group->tags[group->node_base + TAG_INDEX(ti)].group;
+	const tag_value* const pv = &group->tags[group->node_base + TAG_INDEX(ti)];
+
+	if(group->lazy && value_length(pv, group->stamp) == 0)
+	{
+		const fix_error err = resume_message(group->lazy, pv);
+
+		if(err != FE_OK)
+			return err;
+	}
 
-	if(!g)
+	if(value_length(pv, group->stamp) == 0)
 		return set_group_error(group, tag, FE_REQUIRED_TAG_MISSING);
 
+	fix_group* const g = group->arena->groups[pv->offset];
+
 	if(result)
 		*result = g;
 
 	set_error_ctx(group->error, FE_OK, tag, EMPTY_STR);
 	return FE_OK;
 }
+
+// generated decoders support -----------------------------------------------------------------------------
+// string values of all the tags of a node, by position
+fix_error get_fix_node_values(const fix_group* const group, unsigned node, fix_string* const values)
+{
+	if(!group || node >= group->num_nodes || !values)
+		return FE_OTHER;
+
+	// in lazy mode the rest of the message is parsed first
+	if(group->lazy)
+	{
+		const fix_error err = resume_message(group->lazy, NULL);
+
+		if(err != FE_OK)
+			return err;
+	}
+
+	const unsigned node_size = group->info->node_size;
+	const tag_value* const pv = &group->tags[node * node_size];
+
+	for(unsigned i = 0; i < node_size; ++i)
+	{
+		const unsigned len = value_length(&pv[i], group->stamp);
+
+		if(len == 0 || len == GROUP_VALUE)
+			values[i] = EMPTY_STR;
+		else
+			values[i] = (fix_string){ group->base + pv[i].offset, group->base + pv[i].offset + len };
+	}
+
+	return FE_OK;
+}
+
+// group at the given position of a node
+fix_group* get_fix_node_group(const fix_group* const group, unsigned node, unsigned index)
+{
+	if(!group || node >= group->num_nodes || index >= group->info->node_size)
+		return NULL;
+
+	const tag_value* const pv = &group->tags[node * group->info->node_size + index];
+
+	return value_length(pv, group->stamp) == GROUP_VALUE ? group->arena->groups[pv->offset] : NULL;
+}
+
+// group error setter
+fix_error set_fix_group_error(const fix_group* const group, fix_error err, unsigned tag, const fix_string context)
+{
+	if(group)
+		set_error_ctx(group->error, err, tag, context);
+
+	return err;
+}
@@ -0,0 +1,277 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "fix_impl.h"
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+
+// Two-stage pipeline: the caller's thread runs the scanner of the 'framer' parser and copies complete
+// messages to a single-producer single-consumer byte ring, while the pipeline thread takes the messages
+// from the ring and runs the table-driven parser of the 'parser' instance on them.
+
+// ring record: frame header followed by the message bytes, padded to the record alignment;
+// zero length marks the end of the ring data, with the next record at the beginning of the ring.
+// Note: the SOH search kernels may read past the end of a message into the record being written
+// by the producer, but those bytes never affect the result, as each message ends with SOH.
+#define RECORD_ALIGN		16u
+#define RECORD_HEADER_SIZE	((sizeof(fix_frame) + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1))
+#define RECORD_SIZE(n)		(RECORD_HEADER_SIZE + (((n) + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1)))
+
+// the ring must fit at least two messages of the maximum length, as limited by the framer
+#define MIN_RING_SIZE(n)	(2 * RECORD_SIZE((n) + sizeof("8=FIXT.1.1|9=1234567|10=123|")))
+
+// producer and consumer data are kept on separate cache lines
+#define CACHE_LINE	64
+
+struct fix_pipeline
+{
+	// producer side
+	atomic_size_t head;	// write position
+	fix_parser* framer;
+	char pad1[CACHE_LINE - sizeof(atomic_size_t) - sizeof(fix_parser*)];
+
+	// consumer side
+	atomic_size_t tail;	// read position
+	fix_parser* parser;
+	fix_message_handler handler;
+	void* ctx;
+	char pad2[CACHE_LINE - sizeof(atomic_size_t) - sizeof(fix_parser*) - sizeof(fix_message_handler) - sizeof(void*)];
+
+	// shared
+	atomic_bool closed, failed;
+	char* ring;
+	size_t mask;
+	pthread_t thread;
+};
+
+// record access
+static inline
+fix_frame* record_at(const fix_pipeline* const pl, size_t pos)
+{
+	return (fix_frame*)(pl->ring + (pos & pl->mask));
+}
+
+// consumer thread
+static
+void* consumer(void* arg)
+{
+	fix_pipeline* const pl = arg;
+	size_t tail = atomic_load_explicit(&pl->tail, memory_order_relaxed);
+
+	for(;;)
+	{
+		const bool closed = atomic_load_explicit(&pl->closed, memory_order_acquire);
+		const size_t head = atomic_load_explicit(&pl->head, memory_order_acquire);
+
+		if(tail == head)
+		{
+			if(closed)
+				break;
+
+			sched_yield();
+			continue;
+		}
+
+		do
+		{
+			const fix_frame* const frame = record_at(pl, tail);
+
+			if(frame->length == 0)	// wrap around
+			{
+				tail += pl->mask + 1 - (tail & pl->mask);
+				continue;
+			}
+
+			const fix_parser_result* const res = get_fix_message_from_frame(pl->parser, (const char*)frame + RECORD_HEADER_SIZE, frame);
+
+			if(!res)
+			{
+				atomic_store_explicit(&pl->failed, true, memory_order_release);
+				return NULL;
+			}
+
+			pl->handler(res, pl->ctx);
+			tail += RECORD_SIZE(frame->length);
+			atomic_store_explicit(&pl->tail, tail, memory_order_release);
+		} while(tail != head);
+	}
+
+	return NULL;
+}
+
+// producer
+static
+bool wait_for_space(fix_pipeline* const pl, size_t head, size_t n)
+{
+	const size_t size = pl->mask + 1;
+
+	while(size - (head - atomic_load_explicit(&pl->tail, memory_order_acquire)) < n)
+	{
+		if(atomic_load_explicit(&pl->failed, memory_order_acquire))
+			return false;
+
+		sched_yield();
+	}
+
+	return true;
+}
+
+static
+bool push_message(fix_pipeline* const pl, const char* const msg, unsigned len, bool checksum_ok)
+{
+	size_t head = atomic_load_explicit(&pl->head, memory_order_relaxed);
+	const size_t n = RECORD_SIZE(len), contiguous = pl->mask + 1 - (head & pl->mask);
+
+	// the framer's length limit must not have been raised since the ring was allocated
+	if(2 * n > pl->mask + 1)
+	{
+		set_fatal_error(pl->framer, FE_INVALID_MESSAGE_LENGTH);
+		return false;
+	}
+
+	if(n > contiguous)
+	{
+		// mark the end of data and continue from the beginning of the ring
+		if(!wait_for_space(pl, head, contiguous + n))
+			return false;
+
+		record_at(pl, head)->length = 0;
+		head += contiguous;
+	}
+	else if(!wait_for_space(pl, head, n))
+		return false;
+
+	// copy the message
+	fix_frame* const frame = record_at(pl, head);
+
+	*frame = (fix_frame){ 0, len, checksum_ok };
+	memcpy((char*)frame + RECORD_HEADER_SIZE, msg, len);
+
+	// publish
+	atomic_store_explicit(&pl->head, head + n, memory_order_release);
+	return true;
+}
+
+// pipeline interface implementation -------------------------------------------------------------
+fix_pipeline* create_fix_pipeline(fix_parser* const framer, fix_parser* const parser, size_t ring_size,
+								  fix_message_handler handler, void* ctx)
+{
+	if(!framer || !parser || framer == parser || !handler)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	// ring size: power of 2, not less than the minimum
+	size_t n = 1;
+
+	while(n < MIN_RING_SIZE(framer->limits.max_message_length) || n < ring_size)
+		n <<= 1;
+
+	// allocate
+	fix_pipeline* const pl = ALLOC(&parser->allocator, sizeof(fix_pipeline));
+
+	if(!pl)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	memset(pl, 0, sizeof(fix_pipeline));
+
+	if(!(pl->ring = ALLOC(&parser->allocator, n)))
+	{
+		FREE(&parser->allocator, pl);
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	// set-up
+	atomic_init(&pl->head, 0);
+	atomic_init(&pl->tail, 0);
+	atomic_init(&pl->closed, false);
+	atomic_init(&pl->failed, false);
+	pl->framer = framer;
+	pl->parser = parser;
+	pl->handler = handler;
+	pl->ctx = ctx;
+	pl->mask = n - 1;
+
+	// messages are copied to the ring straight from the input, whenever possible
+	framer->flags |= FIX_ZERO_COPY;
+
+	// start consumer
+	const int err = pthread_create(&pl->thread, NULL, consumer, pl);
+
+	if(err != 0)
+	{
+		FREE(&parser->allocator, pl->ring);
+		FREE(&parser->allocator, pl);
+		errno = err;
+		return NULL;
+	}
+
+	return pl;
+}
+
+bool push_fix_pipeline_input(fix_pipeline* const pl, const void* bytes, unsigned num_bytes)
+{
+	if(!pl || atomic_load_explicit(&pl->failed, memory_order_acquire))
+		return false;
+
+	fix_parser* const framer = pl->framer;
+
+	if(!set_scanner_input(framer, bytes, num_bytes))
+		return false;
+
+	while(extract_next_message(framer))
+		if(!push_message(pl, framer->raw, framer->body_length, framer->result.error.code == FE_OK))
+			return false;
+
+	return framer->result.error.code == FE_OK;
+}
+
+fix_error close_fix_pipeline(fix_pipeline* const pl)
+{
+	if(!pl)
+		return FE_OTHER;
+
+	atomic_store_explicit(&pl->closed, true, memory_order_release);
+	pthread_join(pl->thread, NULL);
+
+	const fix_error err = atomic_load_explicit(&pl->failed, memory_order_acquire) ? pl->parser->result.error.code
+								: pl->framer->result.error.code > FE_OTHER ? pl->framer->result.error.code
+								: FE_OK;
+	const fix_allocator allocator = pl->parser->allocator;
+
+	FREE(&allocator, pl->ring);
+	FREE(&allocator, pl);
+	return err;
+}
@@ -30,10 +30,6 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "fix_impl.h"
 
-#ifdef USE_SSE
-#include <xmmintrin.h>
-#endif
-
 // message buffer handling
 static
 char* make_space(fix_parser* const parser, char* dest, unsigned extra_len)
@@ -42,8 +38,9 @@ char* make_space(fix_parser* const parser, char* dest, unsigned extra_len)
 
 	if(len > parser->body_capacity)
 	{
-		// reallocate memory
-		char* const p = realloc(parser->body, len);
+		// reallocate memory, at once for the longest message if the limit allows
+		const unsigned reserve = initial_body_size(parser), capacity = len > reserve ? len : reserve;
+		char* const p = REALLOC(&parser->allocator, parser->body, capacity);
 
 		if(!p)
 		{
@@ -59,7 +56,7 @@ char* make_space(fix_parser* const parser, char* dest, unsigned extra_len)
 
 		// store new pointer
 		parser->body = p;
-		parser->body_capacity = len;
+		parser->body_capacity = capacity;
 	}
 
 	return dest;
@@ -68,13 +65,14 @@ char* make_space(fix_parser* const parser, char* dest, unsigned extra_len)
 // initialisation
 bool init_scanner(fix_parser* parser)
 {
-	char* const p = malloc(INITIAL_BODY_SIZE);
+	const unsigned n = initial_body_size(parser);
+	char* const p = ALLOC(&parser->allocator, n);
 
 	if(!p)
 		return false;
 
 	parser->body = p;
-	parser->body_capacity = INITIAL_BODY_SIZE;
+	parser->body_capacity = n;
 	return true;
 }
 
@@ -99,126 +97,319 @@ bool copy_chunk(scanner_state* const state)
 }
 
 static
-unsigned char copy_cs(char* restrict p, const char* restrict s, unsigned n)
+bool copy_chunk_cs(scanner_state* const state, const fix_kernels* const kernels)
 {
-	unsigned char cs = 0;
-	const char* const end = s + n;
+	const unsigned n = min(state->end - state->src, state->counter);
 
-#ifdef USE_SSE
-	if(end - s >= 16)
-	{
-		__m128i cs128 = _mm_loadu_si128((const __m128i*)s);
+	state->check_sum += kernels->copy_cs(state->dest, state->src, n);
+	state->src += n;
+	state->dest += n;
+	state->counter -= n;
+	return state->counter == 0;
+}
 
-		_mm_storeu_si128((__m128i*)p, cs128);
+// convert and validate message length from the digits in [s, end)
+static
+unsigned read_message_length(const char* s, const char* const end, unsigned max_len)
+{
+	unsigned len = CHAR_TO_INT(*s++) - '0';
 
-		for(s += 16, p += 16; end - s >= 16; s += 16, p += 16)
-		{
-			const __m128i tmp = _mm_loadu_si128((const __m128i*)s);
+	if(len > 9)
+		return 0;
 
-			_mm_storeu_si128((__m128i*)p, tmp);
-			cs128 = _mm_add_epi8(cs128, tmp);
-		}
+	while(s < end)
+	{
+		const unsigned t = CHAR_TO_INT(*s++) - '0';
 
-		cs128 = _mm_add_epi8(cs128, _mm_srli_si128(cs128, 8));
-		cs128 = _mm_add_epi8(cs128, _mm_srli_si128(cs128, 4));
-		cs128 = _mm_add_epi8(cs128, _mm_srli_si128(cs128, 2));
-		cs128 = _mm_add_epi8(cs128, _mm_srli_si128(cs128, 1));
-		cs += _mm_extract_epi16(cs128, 0);	// SSE4: _mm_extract_epi8 ?
-	}
+		if(t > 9)
+			return 0;
 
-	if(end - s >= 8)
-	{
-		__m128i cs64 = _mm_loadl_epi64((const __m128i*)s);
-
-		_mm_storel_epi64((__m128i*)p, cs64);
-		s += 8;
-		p += 8;
-		cs64 = _mm_add_epi8(cs64, _mm_srli_si128(cs64, 4));
-		cs64 = _mm_add_epi8(cs64, _mm_srli_si128(cs64, 2));
-		cs64 = _mm_add_epi8(cs64, _mm_srli_si128(cs64, 1));
-		cs += _mm_extract_epi16(cs64, 0);	// SSE4: _mm_extract_epi8 ?
+		len = len * 10 + t;
+
+		if(len > max_len)
+			return 0;
 	}
-#endif	// #ifdef USE_SSE
 
-	while(s < end)
-		cs += (*p++ = *s++);
+	return len >= sizeof("35=0|49=X|56=Y|34=1|") - 1 ? len : 0;
+}
 
-	return cs;
+static
+bool convert_message_length(const fix_parser* const parser, scanner_state* const state)
+{
+	if(state->counter < 2)
+		return false;
+
+	const unsigned len = read_message_length(state->dest - state->counter, state->dest - 1, parser->limits.max_message_length);
+
+	if(len == 0)
+		return false;
+
+	state->counter = len;
+	return true;
 }
 
+// trailer validators, 'end' points just past the trailing SOH
 static
-bool copy_chunk_cs(scanner_state* const state)
+bool valid_trailer(const char* const end)
 {
-	const unsigned n = min(state->end - state->src, state->counter);
+	return *(const unsigned*)(end - 8) == (SOH | ('1' << 8) | ('0' << 16) | ('=' << 24)) && end[-1] == SOH;
+}
 
-	state->check_sum += copy_cs(state->dest, state->src, n);
-	state->src += n;
-	state->dest += n;
-	state->counter -= n;
-	return state->counter == 0;
+static
+bool valid_checksum(const char* const end, unsigned char check_sum)
+{
+	const unsigned
+		cs2 = CHAR_TO_INT(end[-4]) - '0',
+		cs1 = CHAR_TO_INT(end[-3]) - '0',
+		cs0 = CHAR_TO_INT(end[-2]) - '0';
+
+	return cs2 <= 9 && cs1 <= 9 && cs0 <= 9 && (unsigned)check_sum == cs2 * 100 + cs1 * 10 + cs0;
 }
 
-// covert and validate message length
+// boundaries of a message located in place
+typedef struct
+{
+	const char *body, *end;	// message body (MsgType to CheckSum) and the end of the message
+	fix_error error;		// FE_OK, or framing error
+} message_bounds;
+
+// locate the message starting at 'begin' without copying it;
+// returns 'false' if the input ends before the message does, otherwise returns 'true'
+// and fills in the message boundaries or the framing error
 static
-bool convert_message_length(scanner_state* const state)
+bool locate_message(const fix_parser* const parser, const char* const begin, const char* const end,
+					message_bounds* const bounds)
 {
-	if(state->counter < 2)
-		return false;
+	const unsigned n = end - begin;
 
-	const char* s = state->dest - state->counter;
-	unsigned len = CHAR_TO_INT(*s++) - '0';
+	// header
+	if(memcmp(begin, parser->spec->header, min(n, parser->spec->header_len)) != 0)
+		goto BEGIN_STRING_FAILURE;
 
-	if(len > 9)
+	if(n <= parser->spec->header_len)
 		return false;
 
-	const char* const end = state->dest - 1;
+	// message length
+	const char* const len_begin = begin + parser->spec->header_len;
+	const char* const len_end = memchr(len_begin, SOH, min(end - len_begin, 10));	// max. 9 digits + SOH
 
-	while(s < end)
+	if(!len_end)
 	{
-		const unsigned t = CHAR_TO_INT(*s++) - '0';
-
-		if(t > 9)
+		if(end - len_begin < 10)
 			return false;
 
-		len = len * 10 + t;
+		goto MESSAGE_LENGTH_FAILURE;
+	}
+
+	const unsigned len = read_message_length(len_begin, len_end, parser->limits.max_message_length);
+
+	if(len == 0)
+		goto MESSAGE_LENGTH_FAILURE;
+
+	// message body
+	bounds->body = len_end + 1;
+
+	if((unsigned)(end - bounds->body) < len + sizeof("10=123|") - 1)
+		return false;
+
+	if(bounds->body[len - 1] != SOH)
+		goto MESSAGE_LENGTH_FAILURE;
+
+	// trailer
+	bounds->end = bounds->body + len + sizeof("10=123|") - 1;
+
+	if(!valid_trailer(bounds->end))
+		goto TRAILER_FAILURE;
+
+	// all done
+	bounds->error = FE_OK;
+	return true;
+
+BEGIN_STRING_FAILURE:
+	bounds->error = FE_INVALID_BEGIN_STRING;
+	return true;
+
+MESSAGE_LENGTH_FAILURE:
+	bounds->error = FE_INVALID_MESSAGE_LENGTH;
+	return true;
 
-		if(len > MAX_MESSAGE_LENGTH)
+TRAILER_FAILURE:
+	bounds->error = FE_INVALID_TRAILER;
+	return true;
+}
+
+static
+bool valid_message_checksum(const fix_parser* const parser, const char* const begin, const message_bounds* const bounds)
+{
+	const char* const s = begin + parser->spec->header_len;
+	const char* const trailer = bounds->end - (sizeof("10=123|") - 1);
+
+	return valid_checksum(bounds->end, parser->spec->header_checksum + parser->kernels->sum_bytes(s, trailer - s));
+}
+
+// make the located message current
+static
+void set_message_in_place(fix_parser* const parser, const char* const begin, const message_bounds* const bounds,
+						  bool checksum_ok)
+{
+	const char* const trailer = bounds->end - (sizeof("10=123|") - 1);
+
+	parser->result.error = (fix_error_details){ FE_OK, 0, EMPTY_STR, EMPTY_STR };
+	parser->result.msg_type_code = -1;
+
+	if(!checksum_ok)
+		set_error_ctx(&parser->result.error, FE_INVALID_VALUE, 10, (fix_string){ trailer, bounds->end - 1 });
+
+	parser->frame = (fix_string){ bounds->body, trailer };
+	parser->raw = begin;
+	parser->body_length = bounds->end - begin;
+}
+
+// checksum policy
+static
+bool need_checksum(fix_parser* const parser)
+{
+	if(parser->validation == FIX_VALIDATION_NONE)
+		return false;
+
+	switch(parser->checksum_policy)
+	{
+		case FIX_CHECKSUM_NEVER:
+		case FIX_CHECKSUM_DEFERRED:
 			return false;
+		case FIX_CHECKSUM_SAMPLED:
+			return parser->checksum_counter++ % parser->checksum_sample_rate == 0;
+		default:
+			return true;
 	}
+}
 
-	if(len < sizeof("35=0|49=X|56=Y|34=1|") - 1)
+// deferred checksum verification of the current message
+fix_error verify_message_checksum(const fix_parser* const parser)
+{
+	const char* const end = parser->raw + parser->body_length;
+
+	return valid_checksum(end, parser->kernels->sum_bytes(parser->raw, parser->body_length - (sizeof("10=123|") - 1)))
+			? FE_OK : FE_INVALID_VALUE;
+}
+
+// zero-copy extraction of a message fully contained in the input buffer;
+// returns 'false' without consuming any input if the message is either incomplete or malformed,
+// leaving it to the main scanner to copy the bytes and to report errors, if any;
+// messages in the replay buffer are always copied, as the buffer may be overwritten on the next resync
+static
+bool extract_message_in_place(fix_parser* const parser)
+{
+	scanner_state* const state = &parser->state;
+	message_bounds bounds;
+
+	if(state->replay || !locate_message(parser, state->src, state->end, &bounds) || bounds.error != FE_OK)
 		return false;
 
-	state->counter = len;
+	set_message_in_place(parser, state->src, &bounds,
+						 !state->verify_checksum || valid_message_checksum(parser, state->src, &bounds));
+	state->src = bounds.end;
+	return true;
+}
+
+// message from a frame found by build_fix_frame_index()
+bool extract_framed_message(fix_parser* const parser, const char* const begin, const fix_frame* const frame)
+{
+	const char* const end = begin + frame->length;
+	message_bounds bounds;
+
+	if(!locate_message(parser, begin, end, &bounds) || bounds.error != FE_OK || bounds.end != end)
+		return false;
+
+	set_message_in_place(parser, begin, &bounds, frame->checksum_ok);
 	return true;
 }
 
+// frame index
+fix_error build_fix_frame_index(const fix_parser* const parser, const void* bytes, unsigned num_bytes,
+								fix_frame_index* const index)
+{
+	if(!parser || !index || (!bytes && num_bytes > 0))
+		return FE_OTHER;
+
+	const char *const begin = bytes, *const end = begin + num_bytes, *s = begin;
+	fix_error err = FE_OK;
+	unsigned n = 0;
+	message_bounds bounds;
+
+	while(n < index->max_frames && s < end && locate_message(parser, s, end, &bounds))
+	{
+		if((err = bounds.error) != FE_OK)
+			break;
+
+		index->frames[n++] = (fix_frame){ s - begin, bounds.end - s, valid_message_checksum(parser, s, &bounds) };
+		s = bounds.end;
+	}
+
+	index->num_frames = n;
+	index->tail = s - begin;
+	return err;
+}
+
+// find the next possible begin string in [s, end); a prefix of the begin string at the very end
+// of the range is also a match, as the rest of it may come with the next input chunk
 static
-bool valid_checksum(const scanner_state* const state)
+const char* find_begin_string(const fix_parser* const parser, const char* const begin, const char* const end)
 {
-	const unsigned
-		cs2 = CHAR_TO_INT(state->dest[-4]) - '0',
-		cs1 = CHAR_TO_INT(state->dest[-3]) - '0',
-		cs0 = CHAR_TO_INT(state->dest[-2]) - '0';
+	for(const char* s = begin; (s = parser->kernels->find_pair(s, end, '8', '=')) < end; ++s)
+		if(memcmp(s, parser->spec->header, min(end - s, parser->spec->header_len)) == 0)
+			return s;
 
-	return cs2 <= 9 && cs1 <= 9 && cs0 <= 9 && (unsigned)state->check_sum == cs2 * 100 + cs1 * 10 + cs0;
+	return (end > begin && end[-1] == '8') ? end - 1 : end;
 }
 
-// scanner
-bool extract_next_message(fix_parser* const parser)
+// scanner state machine
+static
+bool scan_message(fix_parser* const parser)
 {
 	scanner_state* const state = &parser->state;
 
 	switch(state->label)
 	{
+		case 5:	// resynchronisation: skip input up to the next begin string
+		{
+			const char* const s = find_begin_string(parser, state->src, state->end);
+
+			parser->stats.discarded_bytes += s - state->src;
+			state->src = s;
+
+			if(s == state->end)
+				return false;
+		}
+			// fall through
+
 		case 0:	// initialisation
+			// line breaks between messages
+			if(parser->flags & FIX_LINE_BREAKS)
+			{
+				while(state->src < state->end && (*state->src == '\n' || *state->src == '\r'))
+					++state->src;
+
+				if(state->src == state->end)
+				{
+					parser->result.error = (fix_error_details){ FE_OK, 0, EMPTY_STR, EMPTY_STR };
+					return (state->label = 0, false);
+				}
+			}
+
+			state->verify_checksum = need_checksum(parser);
+
+			// try complete message first
+			if((parser->flags & FIX_ZERO_COPY) && extract_message_in_place(parser))
+				return true;
+
 			// clear previous error
 			parser->result.error = (fix_error_details){ FE_OK, 0, (fix_string){ parser->body, NULL }, EMPTY_STR };
 			parser->result.msg_type_code = -1;
 
 			// make new state
 			state->dest = parser->body;
-			state->counter = parser->header_len;
+			state->counter = parser->spec->header_len;
 			// fall through
 
 		case 1:	// message header
@@ -227,10 +418,10 @@ bool extract_next_message(fix_parser* const parser)
 				return (state->label = 1, false);
 
 			// validate header
-			if(memcmp(parser->header, parser->body, parser->header_len) != 0)
+			if(memcmp(parser->spec->header, parser->body, parser->spec->header_len) != 0)
 				goto BEGIN_STRING_FAILURE;
 
-			state->check_sum = parser->header_checksum;
+			state->check_sum = parser->spec->header_checksum;
 			state->counter = 0;
 
 			// update context
@@ -257,7 +448,7 @@ bool extract_next_message(fix_parser* const parser)
 			}
 
 			// convert
-			if(!convert_message_length(state))
+			if(!convert_message_length(parser, state))
 				goto MESSAGE_LENGTH_FAILURE;
 
 			// store context
@@ -272,7 +463,8 @@ bool extract_next_message(fix_parser* const parser)
 
 		case 3: // message body
 			// copy
-			if(state->src == state->end || !copy_chunk_cs(state))
+			if(state->src == state->end
+			   || !(state->verify_checksum ? copy_chunk_cs(state, parser->kernels) : copy_chunk(state)))
 				return (state->label = 3, false);
 
 			// validate
@@ -295,14 +487,15 @@ bool extract_next_message(fix_parser* const parser)
 				return (state->label = 4, false);
 
 			// complete message body
+			parser->raw = parser->body;
 			parser->body_length = state->dest - parser->body;
 
 			// validate
-			if(*(const unsigned*)(state->dest - 8) != (SOH | ('1' << 8) | ('0' << 16) | ('=' << 24)) || state->dest[-1] != SOH)
+			if(!valid_trailer(state->dest))
 				goto TRAILER_FAILURE;
 
 			// compare checksum
-			if(!valid_checksum(state))
+			if(state->verify_checksum && !valid_checksum(state->dest, state->check_sum))
 			{	// invalid checksum - a recoverable error
 				set_error(&parser->result.error, FE_INVALID_VALUE, 10);
 				parser->result.error.context.end = state->dest - 1;
@@ -336,9 +529,137 @@ TRAILER_FAILURE:
 
 EXIT:
 	parser->result.error.context.end = state->dest;
+	parser->raw = parser->body;
 	parser->body_length = state->dest - parser->body;
 	return false;
 }
 
+// replay buffer handling: put 'n' bytes from 's' in front of the remaining input
+static
+bool push_replay(fix_parser* const parser, const char* const s, unsigned n)
+{
+	scanner_state* const state = &parser->state;
+	const unsigned rest = state->replay ? state->end - state->src : 0, len = n + rest;
+
+	if(len > parser->replay_capacity)
+	{
+		// reallocate memory
+		const unsigned offset = state->replay ? state->src - parser->replay : 0;
+		char* const p = REALLOC(&parser->allocator, parser->replay, len);
+
+		if(!p)
+		{
+			set_fatal_error(parser, FE_OUT_OF_MEMORY);
+			return false;
+		}
+
+		if(state->replay)
+			state->src = p + offset;
+
+		parser->replay = p;
+		parser->replay_capacity = len;
+	}
+
+	if(state->replay)	// keep the unread part of the replay buffer
+		memmove(parser->replay + n, state->src, rest);
+	else
+	{	// save the input pointers
+		state->next_src = state->src;
+		state->next_end = state->end;
+		state->replay = true;
+	}
+
+	memcpy(parser->replay, s, n);
+	state->src = parser->replay;
+	state->end = parser->replay + len;
+	return true;
+}
+
+// recovery from a framing error: the bytes copied so far are dropped up to the next begin string, if any,
+// and the rest of them is scanned again; otherwise the input gets skipped up to the next begin string
+static
+bool resync(fix_parser* const parser)
+{
+	scanner_state* const state = &parser->state;
+	const char* const p = find_begin_string(parser, parser->body + 1, state->dest);
+
+	if(p < state->dest)
+	{
+		if(!push_replay(parser, p, state->dest - p))
+			return false;	// out of memory
+
+		state->label = 0;
+	}
+	else
+		state->label = 5;
+
+	// update statistics
+	parser->stats.discarded_bytes += p - parser->body;
+
+	if(!state->lost_sync)
+	{
+		state->lost_sync = true;
+		++parser->stats.num_resyncs;
+	}
+
+	// clear error
+	parser->result.error = (fix_error_details){ FE_OK, 0, EMPTY_STR, EMPTY_STR };
+	parser->body_length = 0;
+	return true;
+}
+
+// check for a message started in the input so far but not complete yet
+bool has_partial_message(const fix_parser* const parser)
+{
+	const scanner_state* const state = &parser->state;
+
+	return state->label != 0 && state->label != 5 && state->dest > parser->body;
+}
+
+// scanner
+bool extract_next_message(fix_parser* const parser)
+{
+	scanner_state* const state = &parser->state;
 
+	for(;;)
+	{
+		if(scan_message(parser))
+		{
+			state->lost_sync = false;
+			return true;
+		}
 
+		switch(parser->result.error.code)
+		{
+			case FE_OK:	// end of input
+				if(state->replay)
+				{	// continue with the input following the replayed bytes
+					state->replay = false;
+					state->src = state->next_src;
+					state->end = state->next_end;
+				}
+				else if(state->iov_count > 0)
+				{	// continue with the next input segment
+					state->src = state->iov->iov_base;
+					state->end = state->src + state->iov->iov_len;
+					++state->iov;
+					--state->iov_count;
+				}
+				else
+					return false;
+
+				break;
+
+			case FE_INVALID_BEGIN_STRING:
+			case FE_INVALID_MESSAGE_LENGTH:
+			case FE_INVALID_TRAILER:
+				if(!(parser->flags & FIX_RESYNC) || !resync(parser))
+					return false;
+
+				break;
+
+			default:
+				return false;
+		}
+	}
+}
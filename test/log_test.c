@@ -0,0 +1,275 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define _GNU_SOURCE
+
+#include "test_utils.h"
+#include "FIX44.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+// message handlers
+typedef struct
+{
+	unsigned num_messages;	// in ordered mode, also the index of the next message
+	bool ok;
+} ordered_counter;
+
+// the input is a sequence of the simple message, the message with groups and the nested groups message
+static
+bool valid_message_at(const fix_parser_result* const res, unsigned i)
+{
+	if(res->error.code != FE_OK)
+		return false;
+
+	switch(i % 3)
+	{
+		case 0:		return res->msg_type_code == NewOrderSingle && valid_simple_message(res->root);
+		case 1:		return res->msg_type_code == MarketDataIncrementalRefresh && valid_message_with_groups(res->root);
+		default:	return res->msg_type_code == MarketDataIncrementalRefresh && valid_nested_groups_message(res->root);
+	}
+}
+
+static
+void check_ordered_message(const fix_parser_result* const res, void* ctx)
+{
+	ordered_counter* const counter = ctx;
+
+	if(!valid_message_at(res, counter->num_messages++))
+		counter->ok = false;
+}
+
+static
+void count_messages(const fix_parser_result* const res, void* ctx)
+{
+	if(res->error.code == FE_OK)
+		atomic_fetch_add_explicit((atomic_uint*)ctx, 1, memory_order_relaxed);
+}
+
+// helpers
+static
+fix_string make_log(size_t n)
+{
+	const fix_string msgs[] = { simple_message, message_with_groups_4_4, nested_groups_message };
+
+	return make_n_copies_of_multiple_messages(n, msgs, 3);
+}
+
+// tests ----------------------------------------------------------------------------------------------
+#define NUM_LOG_MESSAGES 30000u
+
+static
+bool log_ordered_test()
+{
+	// small chunks, to have some of them empty and most messages crossing the nominal chunk boundaries
+	const fix_string input = make_log(NUM_LOG_MESSAGES / 3);
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const fix_log_options options = { 4, 500, 0, true };
+	ordered_counter counter = { 0, true };
+	const fix_error err = parse_fix_log(spec, input.begin, fix_string_length(input), &options, check_ordered_message, &counter);
+
+	free_fix_parser_spec(spec);
+	free((void*)input.begin);
+
+	ENSURE(err == FE_OK, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(counter.ok && counter.num_messages == NUM_LOG_MESSAGES, "Unexpected messages: %u", counter.num_messages);
+	PASSED;
+}
+
+static
+bool log_unordered_test()
+{
+	const fix_string input = make_log(NUM_LOG_MESSAGES / 3);
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const fix_log_options options = { 4, 4096, 0, false };
+	atomic_uint num_messages;
+
+	atomic_init(&num_messages, 0);
+
+	const fix_error err = parse_fix_log(spec, input.begin, fix_string_length(input), &options, count_messages, &num_messages);
+
+	free_fix_parser_spec(spec);
+	free((void*)input.begin);
+
+	ENSURE(err == FE_OK, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(num_messages == NUM_LOG_MESSAGES, "Unexpected number of messages: %u", (unsigned)num_messages);
+	PASSED;
+}
+
+static
+bool log_line_breaks_test()
+{
+	// one message per line, with both kinds of line ends
+	const fix_string msgs[] = { simple_message, CONST_LIT("\n"), message_with_groups_4_4, CONST_LIT("\r\n"),
+								nested_groups_message, CONST_LIT("\n") };
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_LOG_MESSAGES / 3, msgs, 6);
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const fix_log_options options = { 4, 500, 0, true };
+	ordered_counter counter = { 0, true };
+	const fix_error err = parse_fix_log(spec, input.begin, fix_string_length(input), &options, check_ordered_message, &counter);
+
+	free_fix_parser_spec(spec);
+	free((void*)input.begin);
+
+	ENSURE(err == FE_OK, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(counter.ok && counter.num_messages == NUM_LOG_MESSAGES, "Unexpected messages: %u", counter.num_messages);
+	PASSED;
+}
+
+static
+bool log_error_test()
+{
+	// a framing error after 1000 good messages, with all the previous messages delivered in order
+	const fix_string good = make_log(1000 / 3 + 1), bad = bad_message_2;
+	const size_t good_len = fix_string_length(good);
+	const fix_string msgs[] = { good, bad, good };
+	const fix_string input = make_n_copies_of_multiple_messages(1, msgs, 3);
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const fix_log_options options = { 4, 1000, 0, true };
+	ordered_counter counter = { 0, true };
+	const fix_error err = parse_fix_log(spec, input.begin, fix_string_length(input), &options, check_ordered_message, &counter);
+
+	// truncated input
+	atomic_uint num_messages;
+
+	atomic_init(&num_messages, 0);
+
+	const fix_error trunc_err = parse_fix_log(spec, good.begin, good_len - 10, NULL, count_messages, &num_messages);
+
+	free_fix_parser_spec(spec);
+	free((void*)good.begin);
+	free((void*)input.begin);
+
+	ENSURE(err == FE_INVALID_MESSAGE_LENGTH, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(counter.ok && counter.num_messages == 3 * (1000 / 3 + 1), "Unexpected messages: %u", counter.num_messages);
+	ENSURE(trunc_err == FE_INVALID_MESSAGE_LENGTH, "Unexpected error (%d): %s", (int)trunc_err, fix_error_to_string(trunc_err));
+	ENSURE(num_messages == 3 * (1000 / 3 + 1) - 1, "Unexpected number of messages: %u", (unsigned)num_messages);
+	PASSED;
+}
+
+static
+bool log_file_test()
+{
+	const fix_string input = make_log(NUM_LOG_MESSAGES / 3);
+	char file_name[] = "/tmp/fullfix-log-XXXXXX";
+	const int fd = mkstemp(file_name);
+	const size_t len = fix_string_length(input);
+	const bool written = fd >= 0 && write(fd, input.begin, len) == (ssize_t)len;
+
+	if(fd >= 0)
+		close(fd);
+
+	free((void*)input.begin);
+
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const fix_log_options options = { 2, 0, 0, true };
+	ordered_counter counter = { 0, true };
+	const fix_error err = written ? parse_fix_log_file(spec, file_name, &options, check_ordered_message, &counter) : FE_OTHER;
+
+	if(fd >= 0)
+		unlink(file_name);
+
+	// missing file
+	const fix_error missing_err = parse_fix_log_file(spec, file_name, NULL, check_ordered_message, &counter);
+	const int missing_errno = errno;
+
+	free_fix_parser_spec(spec);
+
+	ENSURE(written, "Cannot write log file: %s", strerror(errno));
+	ENSURE(err == FE_OK, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(counter.ok && counter.num_messages == NUM_LOG_MESSAGES, "Unexpected messages: %u", counter.num_messages);
+	ENSURE(missing_err == FE_OTHER && missing_errno == ENOENT, "Missing file not detected");
+	PASSED;
+}
+
+#ifdef RELEASE
+// benchmark: throughput with the number of threads from 1 to the number of cores
+#define NUM_MESSAGES 1000000u
+
+static
+bool timed_log_run(const fix_parser_spec* const spec, const fix_string input, unsigned num_threads, bool ordered)
+{
+	const fix_log_options options = { num_threads, 0, 0, ordered };
+	atomic_uint num_messages;
+	struct timespec start, stop;
+
+	atomic_init(&num_messages, 0);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	const fix_error err = parse_fix_log(spec, input.begin, fix_string_length(input), &options, count_messages, &num_messages);
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	const double t = (stop.tv_sec + stop.tv_nsec * 1e-9) - (start.tv_sec + start.tv_nsec * 1e-9);
+
+	printf("-- timed_log_test (%s, %u threads): %zuMB in %0.3f s (%.2f GB/s, %.0fK msg/s)\n",
+		   ordered ? "ordered" : "unordered", num_threads, fix_string_length(input) >> 20, t,
+		   fix_string_length(input) / t * 1e-9, NUM_MESSAGES / t / 1000.);
+
+	return err == FE_OK && num_messages == NUM_MESSAGES;
+}
+
+static
+bool timed_log_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+	const unsigned max_threads = num_cores > 1 ? (unsigned)num_cores : 1;
+	bool res = spec != NULL;
+
+	for(unsigned n = 1; res && n < max_threads; n *= 2)
+		res = timed_log_run(spec, input, n, false) && timed_log_run(spec, input, n, true);
+
+	res = res && timed_log_run(spec, input, max_threads, false) && timed_log_run(spec, input, max_threads, true);
+
+	free_fix_parser_spec(spec);
+	free((void*)input.begin);
+	TEST_END(res);
+}
+#endif	// #ifdef RELEASE
+
+// all tests
+void log_test()
+{
+	puts("# Log parser tests:");
+
+	log_ordered_test();
+	log_unordered_test();
+	log_line_breaks_test();
+	log_error_test();
+	log_file_test();
+
+#ifdef RELEASE
+	timed_log_test();
+#endif
+}
@@ -32,12 +32,18 @@ void scanner_test();
 void parser_test();
 void utils_test();
 void random_messages_test();
+void simd_test();
+void pipeline_test();
+void log_test();
 
 int main()
 {
 	scanner_test();
 	parser_test();
 	random_messages_test();
+	simd_test();
+	pipeline_test();
+	log_test();
 	utils_test();
 
 	return 0;
@@ -35,6 +35,9 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <malloc.h>
 #include <math.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
 
 // test support -------------------------------------------------------------------------------------------
 static unsigned counter;						// for counting messages
@@ -120,6 +123,15 @@ bool full_spec_group_message_validator(const fix_parser_result* const res, const
 	return valid_message_with_groups(res->root);
 }
 
+static
+bool nested_groups_message_validator(const fix_parser_result* const res, const fix_string raw_msg UNUSED)
+{
+	++counter;
+	ENSURE_PARSER_RESULT(res);
+	ENSURE(res->msg_type_code == MarketDataIncrementalRefresh, "Unexpected message type code %d", res->msg_type_code);
+	return valid_nested_groups_message(res->root);
+}
+
 static
 bool duplicate_tag_validator(const fix_parser_result* const res, const fix_string raw_msg UNUSED)
 {
@@ -191,6 +203,19 @@ bool simple_test()
 	TEST_END(res);
 }
 
+static
+bool tag_table_test()
+{
+	counter = 0;
+
+	bool res = parse_input_once(create_fix_parser(tag_table_parser_table, CONST_LIT("FIX.4.4")),
+								simple_message,
+								simple_message_validator);
+
+	ENSURE_COUNTER(1);
+	TEST_END(res);
+}
+
 static
 bool group_test()
 {
@@ -268,6 +293,926 @@ bool mixed_messages_full_spec_test()
 	TEST_END(res);
 }
 
+static
+bool mixed_messages_zero_copy_test()
+{
+	counter = 0;
+
+	const fix_string msgs[] = { simple_message, message_with_groups_4_4, bad_message_with_groups };
+	const size_t n_msgs = sizeof(msgs) / sizeof(msgs[0]);
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_MESSAGES / n_msgs,
+																msgs,
+																n_msgs);
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_parser_flags(parser, FIX_ZERO_COPY);
+
+	bool res = parse_input_once(parser, input, mixed_messages_validator);
+
+	free((void*)input.begin);
+	ENSURE_COUNTER((unsigned)((NUM_MESSAGES / n_msgs) * n_msgs));
+	TEST_END(res);
+}
+
+// batch tests
+#define BATCH_SIZE 7
+
+static
+bool validate_batch(const fix_parser_result** const results, unsigned n)
+{
+	for(unsigned i = 0; i < n; ++i)
+		if(!mixed_messages_validator(results[i], (fix_string){ NULL, NULL }))
+			return false;
+
+	return true;
+}
+
+static
+bool parse_batches(const fix_string input, size_t chunk, unsigned flags)
+{
+	fix_parser* const parser = create_FIX44_parser();
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+	set_fix_parser_flags(parser, flags);
+
+	const fix_parser_result* results[BATCH_SIZE];
+	bool ret = true;
+
+	for(const char* s = input.begin; ret && s < input.end; s += chunk)
+	{
+		const size_t len = s + chunk < input.end ? chunk : (size_t)(input.end - s);
+
+		for(unsigned n = get_first_fix_message_batch(parser, s, len, results, BATCH_SIZE);
+			ret && n > 0;
+			n = get_next_fix_message_batch(parser, results, BATCH_SIZE))
+		{
+			// all the results of the batch must be valid at this point
+			ret = validate_batch(results, n);
+			release_fix_message_batch(parser);
+		}
+
+		const fix_error err = get_fix_parser_error_details(parser)->code;
+
+		if(ret && err != FE_OK)
+		{
+			REPORT_FAILURE("Unexpected parser error (%d): %s", (int)err, fix_error_to_string(err));
+			ret = false;
+		}
+	}
+
+	free_fix_parser(parser);
+	return ret;
+}
+
+static
+bool batch_test()
+{
+	counter = 0;
+
+	const fix_string msgs[] = { simple_message, message_with_groups_4_4, bad_message_with_groups };
+	const size_t n_msgs = sizeof(msgs) / sizeof(msgs[0]);
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_MESSAGES / n_msgs, msgs, n_msgs);
+
+	bool res = parse_batches(input, fix_string_length(input), 0)
+			&& parse_batches(input, fix_string_length(input), FIX_ZERO_COPY)
+			&& parse_batches(input, 100, 0)
+			&& parse_batches(input, 100, FIX_LAZY);
+
+	free((void*)input.begin);
+	ENSURE_COUNTER(4 * (unsigned)((NUM_MESSAGES / n_msgs) * n_msgs));
+	TEST_END(res);
+}
+
+// counting allocator
+typedef struct
+{
+	unsigned num_allocs, num_frees;
+} alloc_counters;
+
+static
+void* counting_malloc(void* ctx, size_t size)
+{
+	++((alloc_counters*)ctx)->num_allocs;
+	return malloc(size);
+}
+
+static
+void* counting_realloc(void* ctx, void* p, size_t size)
+{
+	if(!p)
+		++((alloc_counters*)ctx)->num_allocs;
+
+	return realloc(p, size);
+}
+
+static
+void counting_free(void* ctx, void* p)
+{
+	++((alloc_counters*)ctx)->num_frees;
+	free(p);
+}
+
+static
+bool allocator_test()
+{
+	alloc_counters counters = { 0, 0 };
+	const fix_allocator allocator = { counting_malloc, counting_realloc, counting_free, &counters };
+	fix_parser* const parser = create_FIX44_parser_ex(&allocator);
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+
+	const fix_parser_result* const res = get_first_fix_message(parser, message_with_groups_4_4.begin,
+															   fix_string_length(message_with_groups_4_4));
+	fix_group* group;
+	char* str = NULL;
+	bool ret = false;
+
+	if(!res || !valid_message_with_groups(res->root))
+		goto EXIT;
+
+	// string copy from the first node of a repeating group
+	if(get_fix_tag_as_group(res->root, NoMDEntries, &group) != FE_OK)
+		goto EXIT;
+
+	reset_fix_group_iterator(group);
+
+	if(copy_fix_tag_as_string(group, MDEntryID, &str) != FE_OK || strcmp(str, "BID") != 0)
+	{
+		REPORT_FAILURE("Invalid string copy");
+		goto EXIT;
+	}
+
+	counting_free(&counters, str);
+	ret = true;
+
+EXIT:
+	free_fix_parser(parser);
+	ENSURE(ret, "Parser failure");
+	ENSURE(counters.num_allocs > 2, "Allocator not used (%u allocations)", counters.num_allocs);
+	ENSURE(counters.num_allocs == counters.num_frees, "%u allocations, but %u deallocations",
+		   counters.num_allocs, counters.num_frees);
+	PASSED;
+}
+
+static
+bool group_arena_test()
+{
+	alloc_counters counters = { 0, 0 };
+	const fix_allocator allocator = { counting_malloc, counting_realloc, counting_free, &counters };
+	fix_parser* const parser = create_FIX44_parser_ex(&allocator);
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+
+	// the first message warms up the group memory, then the parser makes no heap calls
+	const fix_string input = make_n_copies(1000, message_with_groups_4_4);
+	const fix_parser_result* res = get_first_fix_message(parser, message_with_groups_4_4.begin,
+														 fix_string_length(message_with_groups_4_4));
+	const fix_parser_stats stats = *get_fix_parser_stats(parser);
+	const unsigned num_allocs = counters.num_allocs;
+	unsigned n = 0;
+	bool ret = res && valid_message_with_groups(res->root) && stats.group_allocs > 0 && stats.group_memory > 0;
+
+	for(res = get_first_fix_message(parser, input.begin, fix_string_length(input)); ret && res; res = get_next_fix_message(parser))
+	{
+		ret = valid_message_with_groups(res->root);
+		++n;
+	}
+
+	const unsigned long group_allocs = get_fix_parser_stats(parser)->group_allocs;
+
+	free_fix_parser(parser);
+	free((void*)input.begin);
+
+	ENSURE(ret && n == 1000, "Parser failure after %u messages", n);
+	ENSURE(group_allocs == stats.group_allocs, "Unexpected group allocations: %lu, expected %lu",
+		   group_allocs, stats.group_allocs);
+	ENSURE(counters.num_allocs == num_allocs, "Unexpected heap allocations: %u, expected %u",
+		   counters.num_allocs, num_allocs);
+	PASSED;
+}
+
+static
+bool invalid_allocator_test()
+{
+	const fix_allocator allocator = { counting_malloc, NULL, NULL, NULL };
+
+	ENSURE(!create_FIX44_parser_ex(&allocator), "Parser created with invalid allocator");
+	ENSURE(errno == EINVAL, "Unexpected errno %d", errno);
+	PASSED;
+}
+
+// lazy mode
+static
+bool lazy_test()
+{
+	counter = 0;
+
+	const fix_string msgs[] = { simple_message, message_with_groups_4_4 };
+	const size_t n_msgs = sizeof(msgs) / sizeof(msgs[0]);
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_MESSAGES / n_msgs,
+																msgs,
+																n_msgs);
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_parser_flags(parser, FIX_LAZY);
+
+	bool res = parse_input_once(parser, input, mixed_messages_validator);
+
+	free((void*)input.begin);
+	ENSURE_COUNTER((unsigned)((NUM_MESSAGES / n_msgs) * n_msgs));
+	TEST_END(res);
+}
+
+static
+bool lazy_validation_test()
+{
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_parser_flags(parser, FIX_LAZY);
+
+	// the duplicate tag in the second group node is only found when the group is accessed
+	const fix_parser_result* const res = get_first_fix_message(parser, bad_message_with_groups.begin,
+															   fix_string_length(bad_message_with_groups));
+	const fix_error res_err = res ? res->error.code : FE_OTHER;
+	char c = 0;
+	const fix_error tag_err = res ? get_fix_tag_as_char(res->root, SenderCompID, &c) : FE_OTHER;
+	const fix_error group_err = res ? get_fix_tag_as_group(res->root, NoMDEntries, NULL) : FE_OTHER;
+	const fix_error err = validate_fix_message(parser);
+	const fix_error_details details = *get_fix_parser_error_details(parser);
+	const bool context_ok = fix_strings_equal(details.context, CONST_LIT("269="));
+
+	free_fix_parser(parser);
+
+	ENSURE(res_err == FE_OK, "Unexpected message error %d", (int)res_err);
+	ENSURE(tag_err == FE_OK && c == 'A', "Unexpected tag error %d", (int)tag_err);
+	ENSURE(group_err == FE_DUPLICATE_TAG, "Unexpected group error %d", (int)group_err);
+	ENSURE(err == FE_DUPLICATE_TAG && details.code == FE_DUPLICATE_TAG && details.tag == 269 && context_ok,
+		   "Unexpected validation result %d for tag %u", (int)details.code, details.tag);
+	PASSED;
+}
+
+// tag projection
+static const unsigned md_projection[] = { SenderCompID, NoMDEntries, MDEntryType, MDEntryPx, MDEntrySize };
+
+static
+bool projected_md_message(const fix_parser_result* const res)
+{
+	fix_group* g = NULL;
+
+	ENSURE_PARSER_RESULT(res);
+	ENSURE(res->msg_type_code == MarketDataIncrementalRefresh, "Unexpected message type code %d", res->msg_type_code);
+	ENSURE(get_fix_tag_as_string(res->root, TargetCompID, NULL) == FE_REQUIRED_TAG_MISSING, "Tag 56 not skipped");
+	ENSURE(get_fix_tag_as_group(res->root, NoMDEntries, &g) == FE_OK && get_fix_group_size(g) == 2, "Invalid group");
+	ENSURE(get_fix_tag_as_string(g, MDEntryID, NULL) == FE_REQUIRED_TAG_MISSING, "Tag 278 not skipped");
+
+	return valid_char(res->root, SenderCompID, 'A')
+		&& valid_long(g, MDEntryType, 0) && valid_double(g, MDEntryPx, 1.37215) && valid_long(g, MDEntrySize, 2500000)
+		&& has_more_fix_nodes(g)
+		&& valid_long(g, MDEntryType, 1) && valid_double(g, MDEntryPx, 1.37224) && valid_long(g, MDEntrySize, 2503200);
+}
+
+static
+bool projection_test()
+{
+	fix_parser* const parser = create_FIX44_parser();
+
+	ENSURE(set_fix_message_projection(parser, MarketDataIncrementalRefresh,
+									  md_projection, sizeof(md_projection) / sizeof(md_projection[0])),
+		   "Failed to set projection");
+
+	// projected message, then a message of another type, then the whole group skipped
+	const fix_parser_result* res = get_first_fix_message(parser, message_with_groups_4_4.begin,
+														 fix_string_length(message_with_groups_4_4));
+	bool ret = projected_md_message(res);
+
+	res = ret ? get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message)) : NULL;
+	ret = ret && res && res->error.code == FE_OK && valid_simple_message(res->root);
+
+	static const unsigned header_only[] = { SenderCompID };
+
+	ret = ret && set_fix_message_projection(parser, MarketDataIncrementalRefresh, header_only, 1);
+	res = ret ? get_first_fix_message(parser, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4)) : NULL;
+	ret = ret && res && res->error.code == FE_OK && valid_char(res->root, SenderCompID, 'A')
+		&& get_fix_tag_as_group(res->root, NoMDEntries, NULL) == FE_REQUIRED_TAG_MISSING;
+
+	// tag out of range: the previous projection stays
+	static const unsigned huge_tag[] = { SenderCompID, UINT_MAX };
+
+	ret = ret && !set_fix_message_projection(parser, MarketDataIncrementalRefresh, huge_tag, 2);
+	res = ret ? get_first_fix_message(parser, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4)) : NULL;
+	ret = ret && res && res->error.code == FE_OK && get_fix_tag_as_group(res->root, NoMDEntries, NULL) == FE_REQUIRED_TAG_MISSING;
+
+	// projection removed
+	ret = ret && set_fix_message_projection(parser, MarketDataIncrementalRefresh, NULL, 0);
+	res = ret ? get_first_fix_message(parser, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4)) : NULL;
+	ret = ret && res && res->error.code == FE_OK && valid_message_with_groups(res->root);
+
+	free_fix_parser(parser);
+	TEST_END(ret);
+}
+
+// nested groups
+static
+bool nested_groups_test()
+{
+	counter = 0;
+
+	bool res = parse_input_once(create_FIX44_parser(), nested_groups_message, nested_groups_message_validator);
+
+	ENSURE_COUNTER(1);
+	TEST_END(res);
+}
+
+// limit violation, with the limit name in the error context
+static
+bool limit_error(const fix_parser_result* const res, unsigned tag, const fix_string limit)
+{
+	return res && res->error.code == FE_OTHER && res->error.tag == tag && fix_strings_equal(res->error.context, limit);
+}
+
+static
+bool group_depth_test()
+{
+	fix_parser* const parser = create_FIX44_parser();
+	fix_parser_limits limits = get_fix_parser_limits(parser);
+
+	// default and invalid depths
+	bool ret = limits.max_group_depth == 16
+			&& !set_fix_parser_limits(parser, &(fix_parser_limits){ limits.max_message_length, limits.max_group_size, 0, 0 })
+			&& !set_fix_parser_limits(parser, &(fix_parser_limits){ limits.max_message_length, limits.max_group_size, MAX_GROUP_DEPTH + 1, 0 });
+
+	// the third level of nesting exceeds the limit
+	limits.max_group_depth = 2;
+	ret = ret && set_fix_parser_limits(parser, &limits);
+
+	const fix_parser_result* res = ret ? get_first_fix_message(parser, nested_groups_message.begin,
+															   fix_string_length(nested_groups_message)) : NULL;
+
+	ret = limit_error(res, 457, CONST_LIT("max_group_depth"));
+
+	// the same with the nested groups skipped by projection
+	static const unsigned header_only[] = { SenderCompID };
+
+	ret = ret && set_fix_message_projection(parser, MarketDataIncrementalRefresh, header_only, 1);
+	res = ret ? get_first_fix_message(parser, nested_groups_message.begin, fix_string_length(nested_groups_message)) : NULL;
+	ret = limit_error(res, 457, CONST_LIT("max_group_depth"))
+		&& set_fix_message_projection(parser, MarketDataIncrementalRefresh, NULL, 0);
+
+	// just enough
+	limits.max_group_depth = 3;
+	ret = ret && set_fix_parser_limits(parser, &limits);
+	res = ret ? get_first_fix_message(parser, nested_groups_message.begin, fix_string_length(nested_groups_message)) : NULL;
+	ret = res && res->error.code == FE_OK && valid_nested_groups_message(res->root);
+
+	free_fix_parser(parser);
+	TEST_END(ret);
+}
+
+// parser limits
+static
+const fix_parser_result* parse_with_limits(fix_parser* const parser, const fix_parser_limits limits, const fix_string msg)
+{
+	return set_fix_parser_limits(parser, &limits) ? get_first_fix_message(parser, msg.begin, fix_string_length(msg)) : NULL;
+}
+
+static
+bool limits_test()
+{
+	fix_parser* const parser = create_FIX44_parser();
+	const fix_parser_limits limits = get_fix_parser_limits(parser);
+
+	// defaults and invalid limits
+	bool ret = limits.max_message_length == 100000 && limits.max_group_size == 1000 && limits.max_tags == 0
+			&& !set_fix_parser_limits(parser, &(fix_parser_limits){ 19, 1000, 16, 0 })
+			&& !set_fix_parser_limits(parser, &(fix_parser_limits){ MAX_MESSAGE_LENGTH + 1, 1000, 16, 0 })
+			&& !set_fix_parser_limits(parser, &(fix_parser_limits){ 100000, 0, 16, 0 })
+			&& !set_fix_parser_limits(parser, &(fix_parser_limits){ 100000, MAX_GROUP_SIZE + 1, 16, 0 });
+
+	// group size: the outer group of the nested groups message has 2 nodes
+	const fix_parser_result* res = ret ? parse_with_limits(parser, (fix_parser_limits){ 1000, 1, 16, 0 }, nested_groups_message) : NULL;
+	ret = res && res->error.code == FE_INVALID_VALUE && res->error.tag == 268;
+	res = ret ? parse_with_limits(parser, (fix_parser_limits){ 1000, 2, 16, 0 }, nested_groups_message) : NULL;
+	ret = res && res->error.code == FE_OK && valid_nested_groups_message(res->root);
+
+	// number of tags: the simple message has 13 tags, from MsgType to TransactTime
+	res = ret ? parse_with_limits(parser, (fix_parser_limits){ 1000, 1000, 16, 12 }, simple_message) : NULL;
+	ret = limit_error(res, TransactTime, CONST_LIT("max_tags"));
+	res = ret ? parse_with_limits(parser, (fix_parser_limits){ 1000, 1000, 16, 13 }, simple_message) : NULL;
+	ret = res && res->error.code == FE_OK && valid_simple_message(res->root);
+
+	// message length: BodyLength of the simple message is 122, and a longer message is a framing error
+	res = ret ? parse_with_limits(parser, (fix_parser_limits){ 122, 1000, 16, 0 }, simple_message) : NULL;
+	ret = res && res->error.code == FE_OK && valid_simple_message(res->root);
+	ret = ret && !parse_with_limits(parser, (fix_parser_limits){ 121, 1000, 16, 0 }, simple_message)
+		&& get_fix_parser_error_details(parser)->code == FE_INVALID_MESSAGE_LENGTH;
+
+	free_fix_parser(parser);
+	TEST_END(ret);
+}
+
+// parsers sharing one specification
+static
+bool shared_spec_test()
+{
+	counter = 0;
+
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+
+	ENSURE(spec, "Null specification: %s", strerror(errno));
+	ENSURE(!create_fix_parser_from_spec(NULL, NULL), "Parser created without specification");
+
+	bool res = parse_input_once(create_fix_parser_from_spec(spec, NULL), message_with_groups_4_4, full_spec_group_message_validator)
+			&& parse_input_once(create_fix_parser_from_spec(spec, NULL), nested_groups_message, nested_groups_message_validator);
+
+	// interleaved messages
+	fix_parser* const p1 = create_fix_parser_from_spec(spec, NULL);
+	fix_parser* const p2 = create_fix_parser_from_spec(spec, NULL);
+
+	res = res && p1 && p2;
+
+	for(unsigned i = 0; res && i < 10; ++i)
+	{
+		const fix_parser_result* const r1 = get_first_fix_message(p1, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4));
+		const fix_parser_result* const r2 = get_first_fix_message(p2, nested_groups_message.begin, fix_string_length(nested_groups_message));
+
+		res = full_spec_group_message_validator(r1, message_with_groups_4_4)
+			&& nested_groups_message_validator(r2, nested_groups_message);
+	}
+
+	free_fix_parser(p1);
+	free_fix_parser(p2);
+	free_fix_parser_spec(spec);
+	ENSURE_COUNTER(22);
+	TEST_END(res);
+}
+
+// reset to the initial state
+static
+bool reset_test()
+{
+	fix_parser* const parser = create_FIX44_parser();
+
+	// a framing error is fatal until reset
+	bool ret = !get_first_fix_message(parser, bad_message_2.begin, fix_string_length(bad_message_2))
+			&& !get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+
+	reset_fix_parser(parser);
+
+	const fix_parser_result* res = ret ? get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message)) : NULL;
+
+	ret = res && res->error.code == FE_OK && valid_simple_message(res->root);
+
+	// a partial message is dropped
+	ret = ret && !get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message) / 2);
+	reset_fix_parser(parser);
+	res = ret ? get_first_fix_message(parser, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4)) : NULL;
+	ret = res && res->error.code == FE_OK && valid_message_with_groups(res->root);
+
+	free_fix_parser(parser);
+	TEST_END(ret);
+}
+
+// the tag values of the previous messages must read as empty, including after the generation wrap-around
+static
+bool stale_values_test()
+{
+	static const fix_string stop_message = CONST_LIT("8=FIX.4.4\x01" "9=127\x01" "35=D\x01" "34=215\x01" "49=CLIENT12\x01"
+		"52=20100225-19:41:57.316\x01" "56=B\x01" "1=Marcel\x01" "11=13346\x01"
+		"21=1\x01" "40=2\x01" "44=5\x01" "54=1\x01" "59=0\x01" "60=20100225-19:39:52.020\x01" "99=5\x01"
+		"10=050\x01");
+
+	// tag 99 is only set in the first message, so its value keeps the stamp of the first generation
+	const unsigned n = 40000;	// more than the number of generations
+	const fix_string input = make_n_copies(n, simple_message);
+	fix_parser* const parser = create_FIX44_parser();
+	const fix_parser_result* res = get_first_fix_message(parser, stop_message.begin, fix_string_length(stop_message));
+	bool ret = res && res->error.code == FE_OK && get_fix_tag_as_string(res->root, StopPx, NULL) == FE_OK;
+	unsigned i = 0;
+
+	for(res = ret ? get_first_fix_message(parser, input.begin, fix_string_length(input)) : NULL;
+		ret && res;
+		res = get_next_fix_message(parser), ++i)
+	{
+		ret = res->error.code == FE_OK && valid_simple_message(res->root)
+			&& get_fix_tag_as_string(res->root, StopPx, NULL) == FE_REQUIRED_TAG_MISSING;
+	}
+
+	free_fix_parser(parser);
+	free((void*)input.begin);
+	ENSURE(ret && i == n, "Stale tag value after %u messages", i);
+	PASSED;
+}
+
+// validation levels
+static
+const fix_parser_result* parse_at_level(fix_parser* const parser, fix_validation_level level, const fix_string msg)
+{
+	return set_fix_parser_validation_level(parser, level) ? get_first_fix_message(parser, msg.begin, fix_string_length(msg)) : NULL;
+}
+
+static
+fix_error error_at_level(fix_parser* const parser, fix_validation_level level, const fix_string msg)
+{
+	const fix_parser_result* const res = parse_at_level(parser, level, msg);
+
+	return res ? res->error.code : FE_OTHER;
+}
+
+static
+fix_group* group_at_level(fix_parser* const parser, fix_validation_level level, const fix_string msg)
+{
+	const fix_parser_result* const res = parse_at_level(parser, level, msg);
+	fix_group* g = NULL;
+
+	return res && res->error.code == FE_OK && get_fix_tag_as_group(res->root, NoMDEntries, &g) == FE_OK ? g : NULL;
+}
+
+static
+bool validation_level_test()
+{
+	// 268=1 for the two group nodes, checksum adjusted
+	static const fix_string too_many_nodes = CONST_LIT("8=FIX.4.4\x01" "9=196\x01" "35=X\x01" "49=A\x01" "56=B\x01" "34=12\x01"
+		"52=20100318-03:21:11.364\x01" "262=A\x01" "268=1\x01"
+		"279=0\x01" "269=0\x01" "278=BID\x01" "55=EUR/USD\x01" "270=1.37215\x01" "15=EUR\x01" "271=2500000\x01" "346=1\x01"
+		"279=0\x01" "269=1\x01" "278=OFFER\x01" "55=EUR/USD\x01" "270=1.37224\x01" "15=EUR\x01" "271=2503200\x01" "346=1\x01"
+		"10=172\x01");
+
+	// unknown tag 9999, wrong checksum
+	static const fix_string unknown_tag = CONST_LIT("8=FIX.4.4\x01" "9=129\x01" "35=D\x01" "34=215\x01" "49=CLIENT12\x01"
+		"52=20100225-19:41:57.316\x01" "56=B\x01" "9999=X\x01" "1=Marcel\x01" "11=13346\x01"
+		"21=1\x01" "40=2\x01" "44=5\x01" "54=1\x01" "59=0\x01" "60=20100225-19:39:52.020\x01"
+		"10=000\x01");
+
+	// group nodes starting with MDEntryType(269) instead of MDUpdateAction(279)
+	static const fix_string wrong_group_start = CONST_LIT("8=FIX.4.4\x01" "9=114\x01" "35=X\x01" "49=A\x01" "56=B\x01" "34=12\x01"
+		"52=20100318-03:21:11.364\x01" "262=A\x01" "268=2\x01"
+		"269=0\x01" "279=0\x01" "270=1.1\x01" "271=100\x01" "279=0\x01" "269=1\x01" "270=1.2\x01" "271=200\x01"
+		"10=221\x01");
+
+	fix_parser* const parser = create_FIX44_parser();
+
+	// default and invalid levels
+	bool ret = get_fix_parser_validation_level(parser) == FIX_VALIDATION_STRICT
+			&& !set_fix_parser_validation_level(parser, FIX_VALIDATION_NONE + 1);
+
+	// duplicate tag: the last value wins
+	ret = ret && error_at_level(parser, FIX_VALIDATION_STRICT, bad_message_with_groups) == FE_DUPLICATE_TAG;
+	fix_group* g = ret ? group_at_level(parser, FIX_VALIDATION_STRUCTURAL, bad_message_with_groups) : NULL;
+
+	ret = g && get_fix_group_size(g) == 2 && valid_long(g, MDEntryType, 1);
+
+	// group count: the extra nodes are dropped
+	ret = ret && error_at_level(parser, FIX_VALIDATION_STRICT, too_many_nodes) == FE_INVALID_GROUP_COUNT;
+	g = ret ? group_at_level(parser, FIX_VALIDATION_STRUCTURAL, too_many_nodes) : NULL;
+	ret = g && get_fix_group_size(g) == 1 && valid_long(g, MDEntryType, 0) && !has_more_fix_nodes(g);
+
+	// group nodes start with the first tag at every level
+	ret = ret && error_at_level(parser, FIX_VALIDATION_STRICT, wrong_group_start) == FE_INVALID_TAG_ORDER
+		&& error_at_level(parser, FIX_VALIDATION_STRUCTURAL, wrong_group_start) == FE_INVALID_TAG_ORDER
+		&& error_at_level(parser, FIX_VALIDATION_NONE, wrong_group_start) == FE_INVALID_TAG_ORDER;
+
+	// checksum
+	ret = ret && error_at_level(parser, FIX_VALIDATION_STRUCTURAL, bad_message_1) == FE_INVALID_VALUE;
+
+	const fix_parser_result* res = ret ? parse_at_level(parser, FIX_VALIDATION_NONE, bad_message_1) : NULL;
+
+	ret = res && res->error.code == FE_OK && valid_simple_message(res->root);
+
+	// unknown tag
+	res = ret ? parse_at_level(parser, FIX_VALIDATION_NONE, unknown_tag) : NULL;
+	ret = res && res->error.code == FE_OK && valid_simple_message(res->root);
+
+	free_fix_parser(parser);
+	TEST_END(ret);
+}
+
+// group node iterators after an error in the group
+static
+bool valid_md_entry_types(const fix_parser_result* const res, fix_error code, unsigned num_nodes, bool all_nodes)
+{
+	fix_group* g = NULL;
+
+	ENSURE(res && res->error.code == code, "Unexpected error (%d)", res ? (int)res->error.code : -1);
+	ENSURE(get_fix_tag_as_group(res->root, NoMDEntries, &g) == FE_OK && g, "Missing group");
+
+	// the iterator starts from the first node
+	for(unsigned i = 0; i < num_nodes; ++i)
+		ENSURE((i == 0 || has_more_fix_nodes(g)) && valid_long(g, MDEntryType, i), "Invalid group node %u", i);
+
+	ENSURE(!all_nodes || !has_more_fix_nodes(g), "Unexpected group node");
+	return true;
+}
+
+static
+bool group_error_iterator_test()
+{
+	// 268=2 for the three group nodes
+	static const fix_string too_many_nodes = CONST_LIT("8=FIX.4.4\x01" "9=266\x01" "35=X\x01" "49=A\x01" "56=B\x01" "34=12\x01"
+		"52=20100318-03:21:11.364\x01" "262=A\x01" "268=2\x01"
+		"279=0\x01" "269=0\x01" "278=BID\x01" "55=EUR/USD\x01" "270=1.37215\x01" "15=EUR\x01" "271=2500000\x01" "346=1\x01"
+		"279=0\x01" "269=1\x01" "278=OFFER\x01" "55=EUR/USD\x01" "270=1.37224\x01" "15=EUR\x01" "271=2503200\x01" "346=1\x01"
+		"279=0\x01" "269=2\x01" "278=TRADE\x01" "55=EUR/USD\x01" "270=1.37220\x01" "15=EUR\x01" "271=1000000\x01" "346=1\x01"
+		"10=195\x01");
+
+	// empty value in the second node; the third one is left empty
+	static const fix_string empty_value = CONST_LIT("8=FIX.4.4\x01" "9=259\x01" "35=X\x01" "49=A\x01" "56=B\x01" "34=12\x01"
+		"52=20100318-03:21:11.364\x01" "262=A\x01" "268=3\x01"
+		"279=0\x01" "269=0\x01" "278=BID\x01" "55=EUR/USD\x01" "270=1.37215\x01" "15=EUR\x01" "271=2500000\x01" "346=1\x01"
+		"279=0\x01" "269=1\x01" "278=OFFER\x01" "55=EUR/USD\x01" "270=\x01" "15=EUR\x01" "271=2503200\x01" "346=1\x01"
+		"279=0\x01" "269=2\x01" "278=TRADE\x01" "55=EUR/USD\x01" "270=1.37220\x01" "15=EUR\x01" "271=1000000\x01" "346=1\x01"
+		"10=101\x01");
+
+	fix_parser* const parser = create_FIX44_parser();
+
+	const bool ret = valid_md_entry_types(parse_at_level(parser, FIX_VALIDATION_STRICT, too_many_nodes), FE_INVALID_GROUP_COUNT, 2, true)
+				  && valid_md_entry_types(parse_at_level(parser, FIX_VALIDATION_STRUCTURAL, too_many_nodes), FE_OK, 2, true)
+				  && valid_md_entry_types(parse_at_level(parser, FIX_VALIDATION_STRUCTURAL, empty_value), FE_EMPTY_VALUE, 2, false);
+
+	free_fix_parser(parser);
+	TEST_END(ret);
+}
+
+// message dispatch
+typedef struct
+{
+	unsigned num_orders, num_md, num_errors;
+	bool ok;
+} dispatch_counters;
+
+static
+void on_new_order(const fix_parser_result* const res, void* ctx)
+{
+	dispatch_counters* const c = ctx;
+
+	++c->num_orders;
+	c->ok = c->ok && res->msg_type_code == NewOrderSingle && valid_simple_message(res->root);
+}
+
+static
+void on_md_refresh(const fix_parser_result* const res, void* ctx)
+{
+	dispatch_counters* const c = ctx;
+
+	++c->num_md;
+	c->ok = c->ok && res->msg_type_code == MarketDataIncrementalRefresh && valid_message_with_groups(res->root);
+}
+
+static
+void on_dispatch_error(const fix_parser_result* const res, void* ctx)
+{
+	dispatch_counters* const c = ctx;
+
+	++c->num_errors;
+	c->ok = c->ok && res->error.code == FE_INVALID_VALUE;
+}
+
+static
+bool dispatch_test()
+{
+	static const FIX44_dispatch_table all_handlers = {
+		.NewOrderSingle = on_new_order,
+		.MarketDataIncrementalRefresh = on_md_refresh,
+		.error = on_dispatch_error
+	};
+
+	// no handler for NewOrderSingle
+	static const FIX44_dispatch_table md_handlers = { .MarketDataIncrementalRefresh = on_md_refresh };
+
+	const fix_string msgs[] = { simple_message, message_with_groups_4_4, bad_message_1 };
+	const unsigned n = 100;
+	const fix_string input = make_n_copies_of_multiple_messages(n, msgs, 3);
+	fix_parser* const parser = create_FIX44_parser();
+	dispatch_counters all = { 0, 0, 0, true }, md = { 0, 0, 0, true };
+
+	const fix_error err = dispatch_FIX44_messages(parser, input.begin, fix_string_length(input), &all_handlers, &all);
+	const fix_error inline_err = dispatch_FIX44_messages_inline(parser, input.begin, fix_string_length(input), &md_handlers, &md);
+
+	// fatal error
+	const fix_error fatal_err = dispatch_FIX44_messages(parser, bad_message_2.begin, fix_string_length(bad_message_2), &all_handlers, &all);
+
+	free_fix_parser(parser);
+	free((void*)input.begin);
+
+	ENSURE(err == FE_OK && inline_err == FE_OK, "Unexpected error (%d, %d)", (int)err, (int)inline_err);
+	ENSURE(all.ok && all.num_orders == n && all.num_md == n && all.num_errors == n, "Unexpected dispatch: %u, %u, %u",
+		   all.num_orders, all.num_md, all.num_errors);
+	ENSURE(md.ok && md.num_orders == 0 && md.num_md == n && md.num_errors == 0, "Unexpected inline dispatch: %u, %u, %u",
+		   md.num_orders, md.num_md, md.num_errors);
+	ENSURE(fatal_err == FE_INVALID_MESSAGE_LENGTH, "Unexpected error (%d): %s", (int)fatal_err, fix_error_to_string(fatal_err));
+	PASSED;
+}
+
+// generated decoders
+static
+bool valid_decoded_order(const FIX44_NewOrderSingle* const msg)
+{
+	return msg->header.has_MsgSeqNum && msg->header.MsgSeqNum == 215
+		&& fix_strings_equal(msg->header.SenderCompID, CONST_LIT("CLIENT12"))
+		&& fix_strings_equal(msg->header.SendingTime, CONST_LIT("20100225-19:41:57.316"))
+		&& fix_strings_equal(msg->Account, CONST_LIT("Marcel"))
+		&& fix_strings_equal(msg->ClOrdID, CONST_LIT("13346"))
+		&& msg->has_HandlInst && msg->HandlInst == '1'
+		&& msg->has_OrdType && msg->OrdType == '2'
+		&& msg->has_Price && msg->Price == 5.
+		&& msg->has_Side && msg->Side == '1'
+		&& !msg->has_OrderQty && fix_string_is_empty(msg->Symbol);
+}
+
+static
+bool valid_decoded_md_entry(const FIX44_component_MDIncGrp_NoMDEntries* const p, char type, double px, double size)
+{
+	return p->has_MDUpdateAction && p->MDUpdateAction == '0'
+		&& p->has_MDEntryType && p->MDEntryType == type
+		&& fix_strings_equal(p->Symbol, CONST_LIT("EUR/USD"))
+		&& p->has_MDEntryPx && fabs(p->MDEntryPx - px) < 1e-10
+		&& p->has_MDEntrySize && p->MDEntrySize == size
+		&& p->has_NumberOfOrders && p->NumberOfOrders == 1;
+}
+
+static
+bool decoder_test()
+{
+	// price 'X'
+	static const fix_string bad_price = CONST_LIT("8=FIX.4.4\x01" "9=122\x01" "35=D\x01" "34=215\x01" "49=CLIENT12\x01"
+		"52=20100225-19:41:57.316\x01" "56=B\x01" "1=Marcel\x01" "11=13346\x01"
+		"21=1\x01" "40=2\x01" "44=X\x01" "54=1\x01" "59=0\x01" "60=20100225-19:39:52.020\x01"
+		"10=000\x01");
+
+	max_align_t memory[1024];
+	fix_decoder_arena arena = { memory, sizeof(memory), 0 }, small_arena = { memory, 16, 0 };
+	FIX44_NewOrderSingle order;
+	FIX44_MarketDataIncrementalRefresh md;
+	fix_parser* const parser = create_FIX44_parser();
+
+	// simple message, in both normal and lazy modes
+	const fix_parser_result* res = get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+	fix_error err = res ? decode_FIX44_NewOrderSingle(res, &arena, &order) : FE_OTHER;
+	bool ret = err == FE_OK && valid_decoded_order(&order);
+
+	ENSURE(ret, "Invalid decoded message (%d)", (int)err);
+	ENSURE(decode_FIX44_MarketDataIncrementalRefresh(res, &arena, &md) == FE_INVALID_MESSAGE_TYPE, "Message type not checked");
+
+	set_fix_parser_flags(parser, FIX_LAZY);
+	res = get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+	err = res ? decode_FIX44_NewOrderSingle(res, &arena, &order) : FE_OTHER;
+	set_fix_parser_flags(parser, 0);
+
+	ENSURE(err == FE_OK && valid_decoded_order(&order), "Invalid decoded lazy message (%d)", (int)err);
+
+	// message with groups
+	res = get_first_fix_message(parser, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4));
+	err = res ? decode_FIX44_MarketDataIncrementalRefresh(res, &arena, &md) : FE_OTHER;
+	ret = err == FE_OK && fix_strings_equal(md.MDReqID, CONST_LIT("A")) && md.num_NoMDEntries == 2
+		&& valid_decoded_md_entry(&md.NoMDEntries[0], '0', 1.37215, 2500000)
+		&& valid_decoded_md_entry(&md.NoMDEntries[1], '1', 1.37224, 2503200);
+
+	ENSURE(ret, "Invalid decoded message with groups (%d)", (int)err);
+
+	// arena too small
+	err = decode_FIX44_MarketDataIncrementalRefresh(res, &small_arena, &md);
+
+	ENSURE(err == FE_OUT_OF_MEMORY, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+
+	// conversion error
+	set_fix_parser_validation_level(parser, FIX_VALIDATION_NONE);
+	res = get_first_fix_message(parser, bad_price.begin, fix_string_length(bad_price));
+	err = res ? decode_FIX44_NewOrderSingle(res, &arena, &order) : FE_OTHER;
+
+	const fix_error_details* const details = res ? get_fix_group_error_details(res->root) : NULL;
+
+	ret = err == FE_INCORRECT_VALUE_FORMAT && details && details->code == err && details->tag == Price
+		&& fix_strings_equal(details->context, CONST_LIT("X"));
+
+	free_fix_parser(parser);
+	ENSURE(ret, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	PASSED;
+}
+
+// eager conversion
+static
+bool eager_conversion_test()
+{
+	// price 'X'
+	static const fix_string bad_price = CONST_LIT("8=FIX.4.4\x01" "9=122\x01" "35=D\x01" "34=215\x01" "49=CLIENT12\x01"
+		"52=20100225-19:41:57.316\x01" "56=B\x01" "1=Marcel\x01" "11=13346\x01"
+		"21=1\x01" "40=2\x01" "44=X\x01" "54=1\x01" "59=0\x01" "60=20100225-19:39:52.020\x01"
+		"10=000\x01");
+
+	fix_parser* const parser = create_FIX44_parser();
+
+	// the side slots of the root group are only added when the flag gets set
+	const fix_parser_result* res = get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+	const size_t plain_memory = get_fix_parser_stats(parser)->group_memory;
+
+	set_fix_parser_flags(parser, FIX_EAGER_CONVERSION);
+
+	// simple message, in both normal and lazy modes
+	res = get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+	double price = 0;
+	bool ret = res && res->error.code == FE_OK && valid_simple_message(res->root)
+			&& get_fix_tag_as_double(res->root, Price, &price) == FE_OK && price == 5.
+			&& get_fix_parser_stats(parser)->group_memory > plain_memory;
+
+	ENSURE(ret, "Invalid converted message");
+
+	set_fix_parser_flags(parser, FIX_EAGER_CONVERSION | FIX_LAZY);
+	res = get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+	ret = res && res->error.code == FE_OK && valid_simple_message(res->root);
+	set_fix_parser_flags(parser, FIX_EAGER_CONVERSION);
+
+	ENSURE(ret, "Invalid converted lazy message");
+
+	// message with groups
+	res = get_first_fix_message(parser, message_with_groups_4_4.begin, fix_string_length(message_with_groups_4_4));
+
+	ENSURE(res && res->error.code == FE_OK && valid_message_with_groups(res->root), "Invalid converted message with groups");
+
+	// conversion error at parse time, even without validation
+	set_fix_parser_validation_level(parser, FIX_VALIDATION_NONE);
+	res = get_first_fix_message(parser, bad_price.begin, fix_string_length(bad_price));
+	ret = res && res->error.code == FE_INCORRECT_VALUE_FORMAT && res->error.tag == Price
+		&& fix_strings_equal(res->error.context, CONST_LIT("X"));
+
+	ENSURE(ret, "Conversion error not reported");
+
+	// no conversion without the flag
+	set_fix_parser_flags(parser, 0);
+	res = get_first_fix_message(parser, bad_price.begin, fix_string_length(bad_price));
+	ret = res && res->error.code == FE_OK && get_fix_tag_as_double(res->root, Price, &price) == FE_INCORRECT_VALUE_FORMAT;
+
+	free_fix_parser(parser);
+	ENSURE(ret, "Unexpected conversion without the flag");
+	PASSED;
+}
+
+// enumerated values
+static
+bool valid_enum(const fix_enum_set* const set, const fix_string value, int ordinal)
+{
+	const int r = get_fix_enum_ordinal(set, value);
+
+	ENSURE(r == ordinal, "Unexpected ordinal of \"%.*s\": %d instead of %d", (int)fix_string_length(value), value.begin, r, ordinal);
+	return true;
+}
+
+static
+bool enum_test()
+{
+	// side 'Z'
+	static const fix_string bad_side = CONST_LIT("8=FIX.4.4\x01" "9=122\x01" "35=D\x01" "34=215\x01" "49=CLIENT12\x01"
+		"52=20100225-19:41:57.316\x01" "56=B\x01" "1=Marcel\x01" "11=13346\x01"
+		"21=1\x01" "40=2\x01" "44=5\x01" "54=Z\x01" "59=0\x01" "60=20100225-19:39:52.020\x01"
+		"10=000\x01");
+
+	// single-character values, both below and above 64, and not in the order of the codes
+	bool ret = valid_enum(&FIX44_Side_enum, CONST_LIT("1"), Side_BUY)
+			&& valid_enum(&FIX44_Side_enum, CONST_LIT("G"), Side_BORROW)
+			&& valid_enum(&FIX44_Side_enum, CONST_LIT("0"), -1)
+			&& valid_enum(&FIX44_Side_enum, CONST_LIT("H"), -1)
+			&& valid_enum(&FIX44_Side_enum, CONST_LIT("11"), -1)
+			&& valid_enum(&FIX44_Side_enum, CONST_LIT("\xC1"), -1)
+			&& valid_enum(&FIX44_PossDupFlag_enum, CONST_LIT("Y"), PossDupFlag_YES)
+			&& valid_enum(&FIX44_PossDupFlag_enum, CONST_LIT("N"), PossDupFlag_NO);
+
+	// multi-character values
+	ret = ret && valid_enum(&FIX44_SecurityType_enum, CONST_LIT("CS"), SecurityType_COMMON_STOCK)
+			  && valid_enum(&FIX44_SecurityType_enum, CONST_LIT("SECPLEDGE"), SecurityType_SECURITIES_PLEDGE)
+			  && valid_enum(&FIX44_SecurityType_enum, CONST_LIT("NONE"), SecurityType_NO_SECURITY_TYPE)
+			  && valid_enum(&FIX44_SecurityType_enum, CONST_LIT("C"), -1)
+			  && valid_enum(&FIX44_SecurityType_enum, CONST_LIT("CSX"), -1)
+			  && valid_enum(&FIX44_SecurityType_enum, CONST_LIT("SECPLEDG"), -1)
+			  && valid_enum(&FIX44_SecurityType_enum, CONST_LIT(""), -1);
+
+	if(!ret)
+		return false;
+
+	// tag accessor
+	fix_parser* const parser = create_FIX44_parser();
+	const fix_parser_result* res = get_first_fix_message(parser, simple_message.begin, fix_string_length(simple_message));
+	int side = -1, ord_type = -1, tif = -1;
+
+	ret = res && res->error.code == FE_OK
+		&& get_fix_tag_as_enum(res->root, Side, &FIX44_Side_enum, &side) == FE_OK && side == Side_BUY
+		&& get_fix_tag_as_enum(res->root, OrdType, &FIX44_OrdType_enum, &ord_type) == FE_OK && ord_type == OrdType_LIMIT
+		&& get_fix_tag_as_enum(res->root, TimeInForce, &FIX44_TimeInForce_enum, &tif) == FE_OK && tif == TimeInForce_DAY;
+
+	ENSURE(ret, "Unexpected enumerated values: %d, %d, %d", side, ord_type, tif);
+
+	// value not in the list
+	set_fix_parser_validation_level(parser, FIX_VALIDATION_NONE);
+	res = get_first_fix_message(parser, bad_side.begin, fix_string_length(bad_side));
+
+	const fix_error err = res ? get_fix_tag_as_enum(res->root, Side, &FIX44_Side_enum, &side) : FE_OTHER;
+	const fix_error_details* const details = res ? get_fix_group_error_details(res->root) : NULL;
+
+	ret = err == FE_INVALID_VALUE && details && details->code == err && details->tag == Side
+		&& fix_strings_equal(details->context, CONST_LIT("Z"));
+
+	free_fix_parser(parser);
+	ENSURE(ret, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	PASSED;
+}
+
 #ifdef RELEASE
 
 static
@@ -338,6 +1283,270 @@ bool timed_full_spec_group_test()
 	TEST_END(res);
 }
 
+// parsers of one specification, one per thread, each with its own copy of the counter
+#define MAX_THREADS 64
+
+typedef struct
+{
+	_Alignas(64) const fix_parser_spec* spec;
+	fix_string input;
+	unsigned num_handled;
+	pthread_t thread;
+} spec_thread;
+
+static
+void* parse_with_spec(void* arg)
+{
+	spec_thread* const t = arg;
+	fix_parser* const parser = create_fix_parser_from_spec(t->spec, NULL);
+	unsigned n = 0;
+
+	for(const fix_parser_result* res = parser ? get_first_fix_message(parser, t->input.begin, fix_string_length(t->input)) : NULL;
+		res;
+		res = get_next_fix_message(parser))
+	{
+		if(res->error.code == FE_OK)
+			++n;
+	}
+
+	free_fix_parser(parser);
+	t->num_handled = n;
+	return NULL;
+}
+
+static
+bool run_spec_threads(const fix_parser_spec* const spec, const fix_string input, unsigned num_threads)
+{
+	static spec_thread threads[MAX_THREADS];
+	struct timespec start, stop;
+	unsigned n = 0, num_handled = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for(; n < num_threads; ++n)
+	{
+		threads[n].spec = spec;
+		threads[n].input = input;
+		threads[n].num_handled = 0;
+
+		if(pthread_create(&threads[n].thread, NULL, parse_with_spec, &threads[n]) != 0)
+			break;
+	}
+
+	for(unsigned i = 0; i < n; ++i)
+	{
+		pthread_join(threads[i].thread, NULL);
+		num_handled += threads[i].num_handled;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	char name[64];
+
+	snprintf(name, sizeof(name), "timed_shared_spec_test (%u threads)", num_threads);
+	print_times(name, (size_t)num_threads * NUM_MESSAGES, &start, &stop);
+	return n == num_threads && num_handled == num_threads * NUM_MESSAGES;
+}
+
+// the aggregate rate is expected to grow linearly with the number of threads, up to the number of cores
+static
+bool timed_shared_spec_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+	const long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+	const unsigned num_threads = num_cores < 1 ? 1 : num_cores > MAX_THREADS ? MAX_THREADS : (unsigned)num_cores;
+	bool res = spec != NULL;
+
+	for(unsigned n = 1; res && n < num_threads; n *= 2)
+		res = run_spec_threads(spec, input, n);
+
+	res = res && run_spec_threads(spec, input, num_threads);
+
+	free_fix_parser_spec(spec);
+	free((void*)input.begin);
+	TEST_END(res);
+}
+
+static
+bool timed_nested_groups_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, nested_groups_message);
+
+	start();
+
+	bool res = parse_input_once(create_FIX44_parser(), input, nested_groups_message_validator);
+
+	stop();
+	free((void*)input.begin);
+	ENSURE_COUNTER(NUM_MESSAGES);
+	PRINT_TIMINGS();
+	TEST_END(res);
+}
+
+static
+bool timed_eager_conversion_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_parser_flags(parser, FIX_EAGER_CONVERSION);
+	start();
+
+	bool res = parse_input_once(parser, input, full_spec_group_message_validator);
+
+	stop();
+	free((void*)input.begin);
+	ENSURE_COUNTER(NUM_MESSAGES);
+	PRINT_TIMINGS();
+	TEST_END(res);
+}
+
+static
+bool header_validator(const fix_parser_result* const res, const fix_string raw_msg UNUSED)
+{
+	++counter;
+	ENSURE_PARSER_RESULT(res);
+	return valid_char(res->root, SenderCompID, 'A') && valid_char(res->root, TargetCompID, 'B');
+}
+
+static
+bool timed_lazy_header_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_parser_flags(parser, FIX_LAZY);
+	start();
+
+	bool res = parse_input_once(parser, input, header_validator);
+
+	stop();
+	free((void*)input.begin);
+	ENSURE_COUNTER(NUM_MESSAGES);
+	PRINT_TIMINGS();
+	TEST_END(res);
+}
+
+static
+bool projected_md_validator(const fix_parser_result* const res, const fix_string raw_msg UNUSED)
+{
+	++counter;
+	return projected_md_message(res);
+}
+
+static
+bool timed_projection_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_message_projection(parser, MarketDataIncrementalRefresh, md_projection, sizeof(md_projection) / sizeof(md_projection[0]));
+	start();
+
+	bool res = parse_input_once(parser, input, projected_md_validator);
+
+	stop();
+	free((void*)input.begin);
+	ENSURE_COUNTER(NUM_MESSAGES);
+	PRINT_TIMINGS();
+	TEST_END(res);
+}
+
+static
+bool timed_full_spec_group_zero_copy_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+
+	set_fix_parser_flags(parser, FIX_ZERO_COPY);
+	start();
+
+	bool res = parse_input_once(parser, input, full_spec_group_message_validator);
+
+	stop();
+	free((void*)input.begin);
+	ENSURE_COUNTER(NUM_MESSAGES);
+	PRINT_TIMINGS();
+	TEST_END(res);
+}
+
+// the same messages via the dispatchers
+static
+void dispatch_group_message(const fix_parser_result* const res, void* ctx)
+{
+	bool* const ok = ctx;
+
+	*ok = full_spec_group_message_validator(res, (fix_string){ NULL, NULL }) && *ok;
+}
+
+static
+bool timed_dispatch_run(bool inlined)
+{
+	static const FIX44_dispatch_table table = { .MarketDataIncrementalRefresh = dispatch_group_message };
+
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+	bool res = true;
+
+	start();
+
+	const fix_error err = inlined
+		? dispatch_FIX44_messages_inline(parser, input.begin, fix_string_length(input), &table, &res)
+		: dispatch_FIX44_messages(parser, input.begin, fix_string_length(input), &table, &res);
+
+	stop();
+	free_fix_parser(parser);
+	free((void*)input.begin);
+
+	res = res && err == FE_OK;
+
+	ENSURE_COUNTER(NUM_MESSAGES);
+
+	if(res)
+		print_times(inlined ? "timed_dispatch_test (inline)" : "timed_dispatch_test", NUM_MESSAGES, &start_time, &stop_time);
+
+	return res;
+}
+
+static
+bool timed_dispatch_test()
+{
+	const bool res = timed_dispatch_run(false) && timed_dispatch_run(true);
+
+	TEST_END(res);
+}
+
+// parsing and decoding
+static
+bool timed_decoder_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+	max_align_t memory[1024];
+	fix_decoder_arena arena = { memory, sizeof(memory), 0 };
+	FIX44_MarketDataIncrementalRefresh md;
+	bool res = true;
+
+	start();
+
+	for(const fix_parser_result* r = get_first_fix_message(parser, input.begin, fix_string_length(input));
+		r && res;
+		r = get_next_fix_message(parser))
+	{
+		++counter;
+		res = decode_FIX44_MarketDataIncrementalRefresh(r, &arena, &md) == FE_OK
+			&& md.num_NoMDEntries == 2 && md.NoMDEntries[1].MDEntrySize == 2503200;
+	}
+
+	stop();
+	free_fix_parser(parser);
+	free((void*)input.begin);
+	ENSURE_COUNTER(NUM_MESSAGES);
+	PRINT_TIMINGS();
+	TEST_END(res);
+}
+
 #endif	// #ifdef RELEASE
 
 // all tests
@@ -346,17 +1555,46 @@ void parser_test()
 	puts("# Parser tests:");
 
 	simple_test();
+	tag_table_test();
 	group_test();
 	duplicate_tag_group_test();
 	full_spec_simple_test();
 	full_spec_bin_test();
 	full_spec_group_test();
 	mixed_messages_full_spec_test();
+	mixed_messages_zero_copy_test();
+	batch_test();
+	allocator_test();
+	group_arena_test();
+	invalid_allocator_test();
+	lazy_test();
+	lazy_validation_test();
+	projection_test();
+	nested_groups_test();
+	group_depth_test();
+	limits_test();
+	shared_spec_test();
+	reset_test();
+	stale_values_test();
+	validation_level_test();
+	group_error_iterator_test();
+	dispatch_test();
+	decoder_test();
+	eager_conversion_test();
+	enum_test();
 
 #ifdef RELEASE
 	timed_simple_test();
 	timed_group_test();
 	timed_simple_full_spec_test();
 	timed_full_spec_group_test();
+	timed_full_spec_group_zero_copy_test();
+	timed_nested_groups_test();
+	timed_shared_spec_test();
+	timed_lazy_header_test();
+	timed_projection_test();
+	timed_dispatch_test();
+	timed_decoder_test();
+	timed_eager_conversion_test();
 #endif	// #ifdef RELEASE
 }
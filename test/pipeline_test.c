@@ -0,0 +1,214 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define _GNU_SOURCE
+
+#include "test_utils.h"
+#include "FIX44.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+// message handler
+typedef struct
+{
+	unsigned num_good, num_bad;
+	bool ok;
+} message_counters;
+
+static
+void count_simple_messages(const fix_parser_result* const res, void* ctx)
+{
+	message_counters* const counters = ctx;
+
+	if(res->error.code == FE_OK && valid_simple_message(res->root))
+		++counters->num_good;
+	else if(res->error.code == FE_INVALID_VALUE && res->error.tag == 10)
+		++counters->num_bad;
+	else
+		counters->ok = false;
+}
+
+// helpers
+static
+bool push_in_chunks(fix_pipeline* const pl, const fix_string input, size_t chunk)
+{
+	for(const char* s = input.begin; s < input.end; s += chunk)
+		if(!push_fix_pipeline_input(pl, s, s + chunk < input.end ? chunk : (size_t)(input.end - s)))
+			return false;
+
+	return true;
+}
+
+// tests ----------------------------------------------------------------------------------------------
+#define NUM_PIPELINE_MESSAGES 100000u
+
+static
+bool pipeline_messages_test()
+{
+	// pairs of good and bad checksum messages, in chunks not aligned to the message boundaries
+	const fix_string msgs[] = { simple_message, bad_message_1 };
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_PIPELINE_MESSAGES / 2, msgs, 2);
+	fix_parser* const framer = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	message_counters counters = { 0, 0, true };
+	fix_pipeline* const pl = create_fix_pipeline(framer, parser, 0, count_simple_messages, &counters);
+	bool ret = false;
+
+	if(!pl)
+	{
+		REPORT_FAILURE("Null pipeline: %s", strerror(errno));
+		goto EXIT;
+	}
+
+	const bool pushed = push_in_chunks(pl, input, 1000);
+	const fix_error err = close_fix_pipeline(pl);
+
+	if(!pushed || err != FE_OK)
+	{
+		REPORT_FAILURE("Pipeline failure (%d): %s", (int)err, fix_error_to_string(err));
+		goto EXIT;
+	}
+
+	if(!counters.ok || counters.num_good != NUM_PIPELINE_MESSAGES / 2 || counters.num_bad != NUM_PIPELINE_MESSAGES / 2)
+	{
+		REPORT_FAILURE("Unexpected messages: %u good, %u bad", counters.num_good, counters.num_bad);
+		goto EXIT;
+	}
+
+	ret = true;
+
+EXIT:
+	free_fix_parser(framer);
+	free_fix_parser(parser);
+	free((void*)input.begin);
+	TEST_END(ret);
+}
+
+static
+bool pipeline_framing_error_test()
+{
+	const fix_string msgs[] = { simple_message, bad_message_2, simple_message };
+	const fix_string input = make_n_copies_of_multiple_messages(1, msgs, 3);
+	fix_parser* const framer = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	message_counters counters = { 0, 0, true };
+	fix_pipeline* const pl = create_fix_pipeline(framer, parser, 0, count_simple_messages, &counters);
+
+	ENSURE(pl, "Null pipeline: %s", strerror(errno));
+
+	const bool pushed = push_fix_pipeline_input(pl, input.begin, fix_string_length(input));
+	const fix_error err = close_fix_pipeline(pl);
+
+	free_fix_parser(framer);
+	free_fix_parser(parser);
+	free((void*)input.begin);
+
+	ENSURE(!pushed, "Framing error not detected");
+	ENSURE(err == FE_INVALID_MESSAGE_LENGTH, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(counters.ok && counters.num_good == 1 && counters.num_bad == 0,
+		   "Unexpected messages: %u good, %u bad", counters.num_good, counters.num_bad);
+	PASSED;
+}
+
+#ifdef RELEASE
+// benchmark: the pipeline against the single-threaded loop, in wall-clock time
+#define NUM_MESSAGES 1000000u
+
+static unsigned num_handled;
+
+static
+void count_messages(const fix_parser_result* const res, void* ctx UNUSED)
+{
+	if(res->error.code == FE_OK)
+		++num_handled;
+}
+
+static
+bool timed_single_thread_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const parser = create_FIX44_parser();
+	struct timespec start, stop;
+
+	num_handled = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for(const char* s = input.begin; s < input.end; s += 4096)
+		for(const fix_parser_result* res = get_first_fix_message(parser, s, s + 4096 < input.end ? 4096 : (unsigned)(input.end - s));
+			res;
+			res = get_next_fix_message(parser))
+		{
+			count_messages(res, NULL);
+		}
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	free_fix_parser(parser);
+	free((void*)input.begin);
+	print_times(__func__, NUM_MESSAGES, &start, &stop);
+	TEST_END(num_handled == NUM_MESSAGES);
+}
+
+static
+bool timed_pipeline_test()
+{
+	const fix_string input = make_n_copies(NUM_MESSAGES, message_with_groups_4_4);
+	fix_parser* const framer = create_FIX44_parser();
+	fix_parser* const parser = create_FIX44_parser();
+	fix_pipeline* const pl = create_fix_pipeline(framer, parser, 0, count_messages, NULL);
+	struct timespec start, stop;
+
+	num_handled = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	const bool pushed = pl && push_in_chunks(pl, input, 4096);
+	const bool res = pl && close_fix_pipeline(pl) == FE_OK && pushed;
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	free_fix_parser(framer);
+	free_fix_parser(parser);
+	free((void*)input.begin);
+	print_times(__func__, NUM_MESSAGES, &start, &stop);
+	TEST_END(res && num_handled == NUM_MESSAGES);
+}
+#endif	// #ifdef RELEASE
+
+// all tests
+void pipeline_test()
+{
+	puts("# Pipeline tests:");
+
+	pipeline_messages_test();
+	pipeline_framing_error_test();
+
+#ifdef RELEASE
+	timed_single_thread_test();
+	timed_pipeline_test();
+#endif
+}
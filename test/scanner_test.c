@@ -33,6 +33,7 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <malloc.h>
 #include <errno.h>
 #include <time.h>
+#include <stdlib.h>
 
 // validators -----------------------------------------------------------------------------------------
 static
@@ -69,6 +70,21 @@ bool simple_message_invalid_checksum(const fix_parser_result* const res, const f
 	return true;
 }
 
+// input of the current zero-copy test
+static fix_string zero_copy_input;
+
+static
+bool zero_copy_message_ok(const fix_parser_result* const res, const fix_string raw_msg)
+{
+	if(!simple_message_ok(res, raw_msg))
+		return false;
+
+	ENSURE(raw_msg.begin >= zero_copy_input.begin && raw_msg.end <= zero_copy_input.end,
+		   "Raw message is not in the input buffer");
+
+	return true;
+}
+
 // helpers --------------------------------------------------------------------------------------------
 static
 bool invoke_twice_and_check(fix_parser* const parser, const size_t i)
@@ -160,6 +176,417 @@ bool invalid_message_length_test()
 	TEST_END(res);
 }
 
+static
+fix_parser* create_zero_copy_parser(const fix_string fix_version)
+{
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, fix_version);
+
+	set_fix_parser_flags(parser, FIX_ZERO_COPY);
+	return parser;
+}
+
+static
+bool zero_copy_test()
+{
+	zero_copy_input = make_n_copies(10, simple_message);
+
+	const bool res = parse_input_once(create_zero_copy_parser(CONST_LIT("FIX.4.4")), zero_copy_input, zero_copy_message_ok);
+
+	free((void*)zero_copy_input.begin);
+	TEST_END(res);
+}
+
+static
+bool zero_copy_multiple_invocation_test()
+{
+	fix_parser* const parser = create_zero_copy_parser(CONST_LIT("FIX.4.4"));
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+
+	bool res = true;
+
+	for(size_t i = 1; res && i < fix_string_length(simple_message); ++i)
+		res = invoke_twice_and_check(parser, i);
+
+	free_fix_parser(parser);
+	TEST_END(res);
+}
+
+static
+bool zero_copy_invalid_checksum_test()
+{
+	const bool res = parse_input_once(create_zero_copy_parser(CONST_LIT("FIX.4.4")),
+									  bad_message_1,
+									  simple_message_invalid_checksum);
+
+	TEST_END(res);
+}
+
+static
+bool zero_copy_invalid_message_length_test()
+{
+	const bool res = invoke_and_check_fatal_error(create_zero_copy_parser(CONST_LIT("FIX.4.4")),
+												  bad_message_2,
+												  FE_INVALID_MESSAGE_LENGTH);
+	TEST_END(res);
+}
+
+// frame index tests
+#define NUM_FRAMES 30
+
+static
+bool frame_index_test()
+{
+	// input: pairs of good and bad checksum messages, plus a partial message at the end
+	const fix_string msgs[] = { simple_message, bad_message_1 };
+	const fix_string pairs = make_n_copies_of_multiple_messages(NUM_FRAMES / 2, msgs, 2);
+	const size_t len = fix_string_length(pairs), msg_len = fix_string_length(simple_message);
+	char* const input = check_ptr(malloc(len + msg_len / 2));
+
+	memcpy(mempcpy(input, pairs.begin, len), simple_message.begin, msg_len / 2);
+	free((void*)pairs.begin);
+
+	// index
+	fix_frame frames[NUM_FRAMES + 5];
+	fix_frame_index index = { frames, NUM_FRAMES + 5, 0, 0 };
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	bool ret = false;
+
+	if(!parser)
+	{
+		REPORT_FAILURE("Null parser: %s", strerror(errno));
+		goto EXIT;
+	}
+
+	const fix_error err = build_fix_frame_index(parser, input, len + msg_len / 2, &index);
+
+	if(err != FE_OK || index.num_frames != NUM_FRAMES || index.tail != len)
+	{
+		REPORT_FAILURE("Unexpected frame index: error %d, %u frames, tail at %u", (int)err, index.num_frames, index.tail);
+		goto EXIT;
+	}
+
+	// parse frames
+	for(unsigned i = 0; i < index.num_frames; ++i)
+	{
+		const fix_frame* const frame = &frames[i];
+
+		if(frame->offset != i * msg_len || frame->length != msg_len || frame->checksum_ok != (i % 2 == 0))
+		{
+			REPORT_FAILURE("Invalid frame %u: offset %u, length %u", i, frame->offset, frame->length);
+			goto EXIT;
+		}
+
+		const fix_parser_result* const res = get_fix_message_from_frame(parser, input, frame);
+
+		if(!res || !(frame->checksum_ok ? simple_message_ok : simple_message_invalid_checksum)(res, get_raw_fix_message(parser)))
+			goto EXIT;
+	}
+
+	// index with the capacity limit
+	index.max_frames = 3;
+
+	if(build_fix_frame_index(parser, input, len, &index) != FE_OK || index.num_frames != 3 || index.tail != 3 * msg_len)
+	{
+		REPORT_FAILURE("Capacity limit ignored");
+		goto EXIT;
+	}
+
+	// a frame not matching the input is a non-fatal error
+	const fix_frame bad_frame = { 1, msg_len, true };
+
+	if(get_fix_message_from_frame(parser, input, &bad_frame) || get_fix_parser_error_details(parser)->code != FE_OTHER
+	   || !get_fix_message_from_frame(parser, input, &frames[0]))
+	{
+		REPORT_FAILURE("Invalid frame not rejected");
+		goto EXIT;
+	}
+
+	// no framed messages while a streamed message is incomplete
+	if(get_first_fix_message(parser, input + len, msg_len / 2)
+	   || get_fix_message_from_frame(parser, input, &frames[0]) || get_fix_parser_error_details(parser)->code != FE_OTHER)
+	{
+		REPORT_FAILURE("Framed message accepted over a partial message");
+		goto EXIT;
+	}
+
+	ret = true;
+
+EXIT:
+	free_fix_parser(parser);
+	free(input);
+	TEST_END(ret);
+}
+
+static
+bool frame_index_error_test()
+{
+	const fix_string msgs[] = { simple_message, bad_message_2 };
+	const fix_string input = make_n_copies_of_multiple_messages(1, msgs, 2);
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	fix_frame frames[2];
+	fix_frame_index index = { frames, 2, 0, 0 };
+	const fix_error err = build_fix_frame_index(parser, input.begin, fix_string_length(input), &index);
+
+	free_fix_parser(parser);
+	free((void*)input.begin);
+
+	ENSURE(err == FE_INVALID_MESSAGE_LENGTH, "Unexpected error (%d): %s", (int)err, fix_error_to_string(err));
+	ENSURE(index.num_frames == 1, "Unexpected number of frames: %u", index.num_frames);
+	ENSURE(index.tail == fix_string_length(simple_message), "Unexpected tail offset: %u", index.tail);
+	PASSED;
+}
+
+// checksum policy tests
+#define NUM_POLICY_MESSAGES 12
+
+static
+bool parse_with_checksum_policy(const fix_string input, fix_checksum_policy policy, unsigned sample_rate, unsigned flags)
+{
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+	set_fix_parser_flags(parser, flags);
+
+	bool ret = set_fix_parser_checksum_policy(parser, policy, sample_rate);
+	unsigned i = 0;
+
+	if(!ret)
+		REPORT_FAILURE("Cannot set checksum policy %d", (int)policy);
+
+	for(const fix_parser_result* res = get_first_fix_message(parser, input.begin, fix_string_length(input));
+		res && ret;
+		res = get_next_fix_message(parser), ++i)
+	{
+		// odd messages have invalid checksum
+		const bool bad = (i % 2 == 1),
+				   verified = policy == FIX_CHECKSUM_ALWAYS || (policy == FIX_CHECKSUM_SAMPLED && i % sample_rate == 0);
+
+		if(res->error.code != ((bad && verified) ? FE_INVALID_VALUE : FE_OK))
+		{
+			REPORT_FAILURE("Policy %d, flags %u, message %u: unexpected error code %d", (int)policy, flags, i, (int)res->error.code);
+			ret = false;
+		}
+		else if(verify_fix_message_checksum(parser) != (bad ? FE_INVALID_VALUE : FE_OK))
+		{
+			REPORT_FAILURE("Policy %d, flags %u, message %u: invalid deferred checksum verification", (int)policy, flags, i);
+			ret = false;
+		}
+		else if(validate_fix_message(parser) != ((bad && (verified || policy == FIX_CHECKSUM_DEFERRED)) ? FE_INVALID_VALUE : FE_OK)
+				|| (res->error.code != FE_OK && res->error.tag != 10))
+		{
+			REPORT_FAILURE("Policy %d, flags %u, message %u: unexpected validation result %d", (int)policy, flags, i, (int)res->error.code);
+			ret = false;
+		}
+	}
+
+	if(ret && i != NUM_POLICY_MESSAGES)
+	{
+		REPORT_FAILURE("Policy %d, flags %u: %u messages parsed instead of %u", (int)policy, flags, i, NUM_POLICY_MESSAGES);
+		ret = false;
+	}
+
+	free_fix_parser(parser);
+	return ret;
+}
+
+static
+bool checksum_policy_test()
+{
+	const fix_string msgs[] = { simple_message, bad_message_1 };
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_POLICY_MESSAGES / 2, msgs, 2);
+	bool res = true;
+
+	for(unsigned flags = 0; res && flags <= FIX_ZERO_COPY; flags += FIX_ZERO_COPY)
+		res = parse_with_checksum_policy(input, FIX_CHECKSUM_ALWAYS, 0, flags)
+		   && parse_with_checksum_policy(input, FIX_CHECKSUM_NEVER, 0, flags)
+		   && parse_with_checksum_policy(input, FIX_CHECKSUM_SAMPLED, 3, flags)
+		   && parse_with_checksum_policy(input, FIX_CHECKSUM_DEFERRED, 0, flags);
+
+	free((void*)input.begin);
+	TEST_END(res);
+}
+
+static
+bool checksum_policy_setter_test()
+{
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+
+	const bool
+		default_ok = get_fix_parser_checksum_policy(parser) == FIX_CHECKSUM_ALWAYS,
+		zero_rate_ok = !set_fix_parser_checksum_policy(parser, FIX_CHECKSUM_SAMPLED, 0),
+		invalid_ok = !set_fix_parser_checksum_policy(parser, (fix_checksum_policy)100, 1),
+		no_message_ok = verify_fix_message_checksum(parser) == FE_OTHER;
+
+	free_fix_parser(parser);
+	ENSURE(default_ok, "Unexpected default checksum policy");
+	ENSURE(zero_rate_ok, "Zero sample rate accepted");
+	ENSURE(invalid_ok, "Invalid policy accepted");
+	ENSURE(no_message_ok, "Checksum verified without a message");
+	PASSED;
+}
+
+// scattered input tests
+#define NUM_IOV_MESSAGES 10
+
+static
+bool parse_segments(const fix_string input, const size_t seg_len, const unsigned flags)
+{
+	const size_t len = fix_string_length(input), n = (len + seg_len - 1) / seg_len;
+	struct iovec* const iov = check_ptr(malloc(n * sizeof(struct iovec)));
+
+	for(size_t i = 0; i < n; ++i)
+		iov[i] = (struct iovec){ (void*)(input.begin + i * seg_len), i < n - 1 ? seg_len : len - i * seg_len };
+
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	bool ret = false;
+	unsigned i = 0;
+
+	if(!parser)
+	{
+		REPORT_FAILURE("Null parser: %s", strerror(errno));
+		goto EXIT;
+	}
+
+	set_fix_parser_flags(parser, flags);
+
+	// the input is fed in two calls, splitting the segments in the middle
+	const struct iovec* const parts[] = { iov, iov + n / 2, iov + n };
+
+	for(unsigned k = 0; k < 2; ++k)
+	{
+		for(const fix_parser_result* res = get_first_fix_message_iov(parser, parts[k], parts[k + 1] - parts[k]);
+			res;
+			res = get_next_fix_message(parser), ++i)
+		{
+			if(!(i % 2 == 0 ? simple_message_ok : simple_message_invalid_checksum)(res, get_raw_fix_message(parser)))
+				goto EXIT;
+		}
+
+		const fix_error err = get_fix_parser_error_details(parser)->code;
+
+		if(err != FE_OK)
+		{
+			REPORT_FAILURE("Unexpected parser error (%d) at segment length %zu: %s", (int)err, seg_len, fix_error_to_string(err));
+			goto EXIT;
+		}
+	}
+
+	if(i != NUM_IOV_MESSAGES)
+	{
+		REPORT_FAILURE("Segment length %zu: %u messages parsed instead of %u", seg_len, i, NUM_IOV_MESSAGES);
+		goto EXIT;
+	}
+
+	ret = true;
+
+EXIT:
+	free_fix_parser(parser);
+	free(iov);
+	return ret;
+}
+
+static
+bool iov_test()
+{
+	const fix_string msgs[] = { simple_message, bad_message_1 };
+	const fix_string input = make_n_copies_of_multiple_messages(NUM_IOV_MESSAGES / 2, msgs, 2);
+	bool res = true;
+
+	for(size_t seg_len = 1; res && seg_len <= 2 * fix_string_length(simple_message) + 1; ++seg_len)
+		res = parse_segments(input, seg_len, 0) && parse_segments(input, seg_len, FIX_ZERO_COPY);
+
+	free((void*)input.begin);
+	TEST_END(res);
+}
+
+// resynchronisation tests
+static
+bool resync_chunked_input(const fix_string input, const size_t chunk, const unsigned flags, const unsigned long discarded)
+{
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+	set_fix_parser_flags(parser, flags);
+
+	unsigned num_good = 0, num_bad = 0;
+	bool ret = false;
+
+	for(const char* s = input.begin; s < input.end; s += chunk)
+	{
+		const fix_parser_result* res = get_first_fix_message(parser, s, s + chunk < input.end ? chunk : (size_t)(input.end - s));
+
+		for(; res; res = get_next_fix_message(parser))
+		{
+			if(res->error.code == FE_OK && simple_message_ok(res, get_raw_fix_message(parser)))
+				++num_good;
+			else if(simple_message_invalid_checksum(res, get_raw_fix_message(parser)))
+				++num_bad;
+			else
+				goto EXIT;
+		}
+
+		const fix_error err = get_fix_parser_error_details(parser)->code;
+
+		if(err != FE_OK)
+		{
+			REPORT_FAILURE("Unexpected parser error (%d) at chunk size %zu: %s", (int)err, chunk, fix_error_to_string(err));
+			goto EXIT;
+		}
+	}
+
+	const fix_parser_stats* const stats = get_fix_parser_stats(parser);
+
+	if(num_good != 3 || num_bad != 1 || stats->discarded_bytes != discarded || stats->num_resyncs != 3)
+	{
+		REPORT_FAILURE("Chunk size %zu: %u good and %u bad messages, %lu bytes discarded in %lu resyncs",
+					   chunk, num_good, num_bad, stats->discarded_bytes, stats->num_resyncs);
+		goto EXIT;
+	}
+
+	ret = true;
+
+EXIT:
+	free_fix_parser(parser);
+	return ret;
+}
+
+static
+bool resync_test()
+{
+	// good messages interleaved with garbage, a message with invalid length, and a truncated message;
+	// the last two pieces of garbage make a single loss of synchronisation
+	const fix_string garbage_1 = CONST_LIT("xyz8=FIX"), garbage_2 = CONST_LIT("garbage"),
+					 truncated = { simple_message.begin, simple_message.begin + 50 };
+	const fix_string msgs[] = { garbage_1, simple_message, bad_message_2, simple_message, garbage_2,
+								truncated, simple_message, bad_message_1 };
+	const fix_string input = make_n_copies_of_multiple_messages(1, msgs, sizeof(msgs) / sizeof(msgs[0]));
+	const unsigned long discarded = fix_string_length(garbage_1) + fix_string_length(bad_message_2)
+								  + fix_string_length(garbage_2) + fix_string_length(truncated);
+	bool res = true;
+
+	for(size_t chunk = 1; res && chunk <= fix_string_length(input); ++chunk)
+		res = resync_chunked_input(input, chunk, FIX_RESYNC, discarded)
+		   && resync_chunked_input(input, chunk, FIX_RESYNC | FIX_ZERO_COPY, discarded);
+
+	free((void*)input.begin);
+	TEST_END(res);
+}
+
+static
+bool resync_disabled_test()
+{
+	const fix_string msgs[] = { CONST_LIT("garbage"), simple_message };
+	const fix_string input = make_n_copies_of_multiple_messages(1, msgs, 2);
+	const bool res = invoke_and_check_fatal_error(create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4")),
+												  input,
+												  FE_INVALID_BEGIN_STRING);
+	free((void*)input.begin);
+	TEST_END(res);
+}
+
 #ifdef RELEASE
 #define NUM_MESSAGES 1000000
 
@@ -180,6 +607,70 @@ bool scanner_timed_test()
 	TEST_END(res);
 }
 
+static
+bool no_checksum_scanner_timed_test()
+{
+	const fix_string msgs = make_n_copies(NUM_MESSAGES, simple_message);
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	struct timespec start, stop;
+
+	set_fix_parser_checksum_policy(parser, FIX_CHECKSUM_NEVER, 0);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+	const bool res = parse_input_once(parser, msgs, simple_message_quick_validator);
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stop);
+	free((void*)msgs.begin);
+	print_times(__func__, NUM_MESSAGES, &start, &stop);
+	TEST_END(res);
+}
+
+static
+bool zero_copy_scanner_timed_test()
+{
+	const fix_string msgs = make_n_copies(NUM_MESSAGES, simple_message);
+	fix_parser* const parser = create_zero_copy_parser(CONST_LIT("FIX.4.4"));
+	struct timespec start, stop;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+	const bool res = parse_input_once(parser, msgs, simple_message_quick_validator);
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stop);
+	free((void*)msgs.begin);
+	print_times(__func__, NUM_MESSAGES, &start, &stop);
+	TEST_END(res);
+}
+
+static
+bool frame_index_timed_test()
+{
+	const fix_string msgs = make_n_copies(NUM_MESSAGES, simple_message);
+	fix_frame* const frames = check_ptr(malloc(NUM_MESSAGES * sizeof(fix_frame)));
+	fix_frame_index index = { frames, NUM_MESSAGES, 0, 0 };
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+	struct timespec start, stop;
+	bool res = true;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+	if(build_fix_frame_index(parser, msgs.begin, fix_string_length(msgs), &index) != FE_OK || index.num_frames != NUM_MESSAGES)
+	{
+		REPORT_FAILURE("Framing failed");
+		res = false;
+	}
+
+	for(unsigned i = 0; res && i < index.num_frames; ++i)
+		res = simple_message_quick_validator(get_fix_message_from_frame(parser, msgs.begin, &frames[i]), msgs);
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stop);
+	free_fix_parser(parser);
+	free(frames);
+	free((void*)msgs.begin);
+	print_times(__func__, NUM_MESSAGES, &start, &stop);
+	TEST_END(res);
+}
+
 #endif
 
 // all tests
@@ -192,8 +683,22 @@ void scanner_test()
 	invalid_header_test();
 	invalid_checksum_test();
 	invalid_message_length_test();
+	zero_copy_test();
+	zero_copy_multiple_invocation_test();
+	zero_copy_invalid_checksum_test();
+	zero_copy_invalid_message_length_test();
+	frame_index_test();
+	frame_index_error_test();
+	resync_test();
+	resync_disabled_test();
+	checksum_policy_test();
+	checksum_policy_setter_test();
+	iov_test();
 
 #ifdef RELEASE
 	scanner_timed_test();
+	no_checksum_scanner_timed_test();
+	zero_copy_scanner_timed_test();
+	frame_index_timed_test();
 #endif
 }
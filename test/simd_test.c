@@ -0,0 +1,233 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define _GNU_SOURCE
+
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// test messages have the 'Account' tag of all lengths from 1 to MAX_ACCOUNT_LENGTH,
+// so the message bodies and tag values come at all possible lengths and alignments
+#define MAX_ACCOUNT_LENGTH 200
+
+static char accounts[MAX_ACCOUNT_LENGTH][MAX_ACCOUNT_LENGTH + 1];
+
+// message composer
+static
+char* compose_message(char* p, const char* account, bool bad_checksum)
+{
+	char body[MAX_ACCOUNT_LENGTH + 200];
+	const int n = snprintf(body, sizeof(body),
+						   "35=D\x01" "34=215\x01" "49=CLIENT12\x01" "52=20100225-19:41:57.316\x01" "56=B\x01"
+						   "1=%s\x01" "11=13346\x01" "21=1\x01" "40=2\x01" "44=5\x01" "54=1\x01" "59=0\x01"
+						   "60=20100225-19:39:52.020\x01", account);
+
+	char* const msg = p;
+
+	p += sprintf(p, "8=FIX.4.4\x01" "9=%d\x01", n);
+	p = mempcpy(p, body, n);
+
+	unsigned char cs = 0;
+
+	for(const char* s = msg; s < p; ++s)
+		cs += *s;
+
+	if(bad_checksum)
+		++cs;
+
+	return p + sprintf(p, "10=%03u\x01", (unsigned)cs);
+}
+
+// total length of the garbage inserted between the messages
+static unsigned long garbage_length;
+
+// garbage of the given length, with an incomplete begin string somewhere in it
+static
+char* compose_garbage(char* p, unsigned len)
+{
+	static const char garbage[] = "x8=FIX.4.x8=FIX.8=8=FIX.4.4x";
+
+	for(unsigned i = 0; i < len; ++i)
+		*p++ = garbage[i % (sizeof(garbage) - 1)];
+
+	garbage_length += len;
+	return p;
+}
+
+static
+fix_string make_messages(bool with_bad_checksums, bool with_garbage)
+{
+	char* const buff = check_ptr(malloc(MAX_ACCOUNT_LENGTH * (MAX_ACCOUNT_LENGTH + 400)));
+	char* p = buff;
+
+	garbage_length = 0;
+
+	for(unsigned i = 0; i < MAX_ACCOUNT_LENGTH; ++i)
+	{
+		if(with_garbage)
+			p = compose_garbage(p, i % 90 + 1);
+
+		p = compose_message(p, accounts[i], with_bad_checksums && i % 3 == 0);
+	}
+
+	return (fix_string){ buff, p };
+}
+
+static
+void make_accounts()
+{
+	static const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz_0123456789";
+
+	for(unsigned i = 0; i < MAX_ACCOUNT_LENGTH; ++i)
+	{
+		for(unsigned j = 0; j <= i; ++j)
+			accounts[i][j] = letters[rand() % (sizeof(letters) - 1)];
+
+		accounts[i][i + 1] = 0;
+	}
+}
+
+// parse all the messages using the given SIMD level and parser flags
+static
+bool parse_messages(const fix_string input, fix_simd_level level, unsigned flags, bool with_bad_checksums)
+{
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+
+	if(!set_fix_parser_simd_level(parser, level))
+	{
+		free_fix_parser(parser);
+		return true;	// not supported on this CPU
+	}
+
+	set_fix_parser_flags(parser, flags);
+
+	bool ret = true;
+	unsigned i = 0;
+
+	for(const fix_parser_result* res = get_first_fix_message(parser, input.begin, fix_string_length(input));
+		res && ret;
+		res = get_next_fix_message(parser), ++i)
+	{
+		if(with_bad_checksums && i % 3 == 0)
+		{
+			if(res->error.code != FE_INVALID_VALUE || res->error.tag != 10)
+			{
+				REPORT_FAILURE("Level %d, flags %u, message %u: invalid checksum not detected", (int)level, flags, i);
+				ret = false;
+			}
+		}
+		else if(!parser_result_ok(res, __FILE__, __LINE__) || !valid_string(res->root, 1, fix_string_from_c_string(accounts[i])))
+		{
+			REPORT_FAILURE("Level %d, flags %u, message %u: parser failure", (int)level, flags, i);
+			ret = false;
+		}
+	}
+
+	if(ret && i != MAX_ACCOUNT_LENGTH)
+	{
+		REPORT_FAILURE("Level %d, flags %u: %u messages parsed instead of %u", (int)level, flags, i, MAX_ACCOUNT_LENGTH);
+		ret = false;
+	}
+
+	if(ret && (flags & FIX_RESYNC) && get_fix_parser_stats(parser)->discarded_bytes != garbage_length)
+	{
+		REPORT_FAILURE("Level %d, flags %u: %lu bytes discarded instead of %lu",
+					   (int)level, flags, get_fix_parser_stats(parser)->discarded_bytes, garbage_length);
+		ret = false;
+	}
+
+	free_fix_parser(parser);
+	return ret;
+}
+
+// tests ----------------------------------------------------------------------------------------------
+static
+bool simd_levels_test()
+{
+	fix_parser* const parser = create_fix_parser(simple_message_parser_table, CONST_LIT("FIX.4.4"));
+
+	ENSURE(parser, "Null parser: %s", strerror(errno));
+
+	const fix_simd_level best = get_fix_parser_simd_level(parser);
+	const bool
+		auto_ok = best != FIX_SIMD_AUTO,
+		none_ok = set_fix_parser_simd_level(parser, FIX_SIMD_NONE) && get_fix_parser_simd_level(parser) == FIX_SIMD_NONE,
+		best_ok = set_fix_parser_simd_level(parser, best) && get_fix_parser_simd_level(parser) == best;
+
+	free_fix_parser(parser);
+	ENSURE(auto_ok, "SIMD level has not been selected");
+	ENSURE(none_ok, "Cannot select scalar code");
+	ENSURE(best_ok, "Cannot select SIMD level %d", (int)best);
+	PASSED;
+}
+
+static
+bool simd_kernels_test()
+{
+	const fix_string good = make_messages(false, false), bad = make_messages(true, false);
+	bool ret = true;
+
+	for(fix_simd_level level = FIX_SIMD_NONE; ret && level <= FIX_SIMD_AVX512; ++level)
+		ret = parse_messages(good, level, 0, false)
+			&& parse_messages(good, level, FIX_ZERO_COPY, false)
+			&& parse_messages(bad, level, 0, true)
+			&& parse_messages(bad, level, FIX_ZERO_COPY, true);
+
+	free((void*)good.begin);
+	free((void*)bad.begin);
+	TEST_END(ret);
+}
+
+static
+bool simd_resync_test()
+{
+	const fix_string input = make_messages(true, true);
+	bool ret = true;
+
+	for(fix_simd_level level = FIX_SIMD_NONE; ret && level <= FIX_SIMD_AVX512; ++level)
+		ret = parse_messages(input, level, FIX_RESYNC, true)
+			&& parse_messages(input, level, FIX_RESYNC | FIX_ZERO_COPY, true);
+
+	free((void*)input.begin);
+	TEST_END(ret);
+}
+
+// all tests
+void simd_test()
+{
+	puts("# SIMD tests:");
+
+	make_accounts();
+	simd_levels_test();
+	simd_kernels_test();
+	simd_resync_test();
+}
@@ -298,7 +298,7 @@ const fix_message_info* simple_message_parser_table(const fix_string type)
 {
 	if(fix_string_length(type) == 1 && *type.begin == 'D')
 	{
-		static const fix_message_info mi = { { 12, 0, simple_message_tag_info, empty_group_info }, 0 };
+		static const fix_message_info mi = { { 12, 0, simple_message_tag_info, empty_group_info, NULL, NULL }, 0 };
 
 		return &mi;
 	}
@@ -317,7 +317,47 @@ const fix_message_info* missing_tag_parser_table(const fix_string type)
 {
 	if(fix_string_length(type) == 1 && *type.begin == 'D')
 	{
-		static const fix_message_info mi = { { 12, 0, missing_simple_message_tag_info, empty_group_info }, 0 };
+		static const fix_message_info mi = { { 12, 0, missing_simple_message_tag_info, empty_group_info, NULL, NULL }, 0 };
+
+		return &mi;
+	}
+
+	return NULL;
+}
+
+// specification for simple message via tag lookup table: tags below 35 are in the dense array,
+// the others in the hash; the tag info function is never called
+static
+unsigned no_tag_info(unsigned tag UNUSED)
+{
+	return NONE;
+}
+
+#define NT 0xFFFF
+
+static const uint16_t simple_message_dense_tags[] =
+{
+	NT, 16, NT, NT, NT, NT, NT, NT, NT, NT, NT, 20, NT, NT, NT, NT,
+	NT, NT, NT, NT, NT, 24, NT, NT, NT, NT, NT, NT, NT, NT, NT, NT,
+	NT, NT, 0
+};
+
+static const uint32_t simple_message_hash_keys[] = { 0, 60, 52, 44, 49, 54, 0, 59, 0, 56, 0, 40, 0, 0, 0, 0 };
+static const uint16_t simple_message_hash_infos[] = { NT, 44, 8, 32, 4, 36, NT, 40, NT, 12, NT, 28, NT, NT, NT, NT };
+
+static const fix_tag_table simple_message_tag_table =
+{
+	simple_message_dense_tags, sizeof(simple_message_dense_tags) / sizeof(simple_message_dense_tags[0]),
+	simple_message_hash_keys, simple_message_hash_infos, 0x9e3779b1u, 28
+};
+
+#undef NT
+
+const fix_message_info* tag_table_parser_table(const fix_string type)
+{
+	if(fix_string_length(type) == 1 && *type.begin == 'D')
+	{
+		static const fix_message_info mi = { { 12, 0, no_tag_info, empty_group_info, &simple_message_tag_table, NULL }, 0 };
 
 		return &mi;
 	}
@@ -342,7 +382,16 @@ bad_message_with_groups_4_4 = LIT("8=FIX.4.4\x01" "9=196\x01" "35=X\x01" "49=A\x
 bad_message_with_groups = LIT("8=FIX.4.4\x01" "9=196\x01" "35=X\x01" "49=A\x01" "56=B\x01" "34=12\x01" "52=20100318-03:21:11.364\x01" "262=A\x01" "268=2\x01"
 							  "279=0\x01" "269=0\x01" "278=BID\x01" "55=EUR/USD\x01" "270=1.37215\x01" "15=EUR\x01" "271=2500000\x01" "346=1\x01"
 							  "269=1\x01" "279=0\x01" "278=OFFER\x01" "55=EUR/USD\x01" "270=1.37224\x01" "15=EUR\x01" "271=2503200\x01" "346=1\x01"
-							  "10=173\x01");	// invalid tag '269' on the third line above
+							  "10=173\x01"),	// invalid tag '269' on the third line above
+nested_groups_message = LIT("8=FIX.4.4\x01" "9=262\x01" "35=X\x01" "49=A\x01" "56=B\x01" "34=12\x01" "52=20100318-03:21:11.364\x01" "262=A\x01" "268=2\x01"
+							"279=0\x01" "269=0\x01" "55=EUR/USD\x01" "711=2\x01"
+								"311=EUR\x01" "457=2\x01" "458=EU1\x01" "459=4\x01" "458=EU2\x01" "459=8\x01"
+								"311=USD\x01" "457=1\x01" "458=US1\x01" "459=4\x01"
+							"270=1.37215\x01" "271=2500000\x01"
+							"279=0\x01" "269=1\x01" "55=EUR/USD\x01" "711=1\x01"
+								"311=EUR\x01" "457=1\x01" "458=EU1\x01" "459=4\x01"
+							"270=1.37224\x01" "271=2503200\x01"
+							"10=247\x01");	// groups nested 3 levels deep
 
 static
 unsigned message_with_groups_group_1_tag_info(unsigned tag)
@@ -379,7 +428,7 @@ unsigned message_with_groups_root_tag_info(unsigned tag)
 static
 const fix_group_info* message_with_groups_group_info(unsigned tag)
 {
-	static const fix_group_info group_1_spec = { 8, 279, message_with_groups_group_1_tag_info, empty_group_info };
+	static const fix_group_info group_1_spec = { 8, 279, message_with_groups_group_1_tag_info, empty_group_info, NULL, NULL };
 
 	return tag == 268 ? &group_1_spec : NULL;
 }
@@ -388,7 +437,7 @@ const fix_message_info* message_with_groups_parser_table(const fix_string type)
 {
 	if(fix_string_length(type) == 1 && *type.begin == 'X')
 	{
-		static const fix_message_info mi = { { 6, 0, message_with_groups_root_tag_info, message_with_groups_group_info }, 0 };
+		static const fix_message_info mi = { { 6, 0, message_with_groups_root_tag_info, message_with_groups_group_info, NULL, NULL }, 0 };
 
 		return &mi;
 	}
@@ -472,3 +521,78 @@ bool valid_message_with_groups(fix_group* const group)
 	ENSURE(!has_more_fix_nodes(g), "Unexpected next group node");
 	return true;
 }
+
+// underlying group of the message with nested groups: underlying symbol and alternative security IDs
+static
+bool valid_underlying(fix_group* const group, const char* const symbol, unsigned num_ids,
+					  const char* const ids[], const long sources[])
+{
+	fix_group* g = NULL;
+	const fix_error err = get_fix_tag_as_group(group, 457, &g);
+
+	ENSURE(err == FE_OK, "Error %d while getting group pointer from tag 457", (int)err);
+
+	const unsigned num_nodes = get_fix_group_size(g);
+
+	ENSURE(num_nodes == num_ids, "Invalid number of nodes: %u", num_nodes);
+
+	if(!valid_string(group, 311, (fix_string){ symbol, symbol + strlen(symbol) }))
+		return false;
+
+	for(unsigned i = 0; i < num_ids; ++i)
+	{
+		if(!valid_string(g, 458, (fix_string){ ids[i], ids[i] + strlen(ids[i]) }) || !valid_long(g, 459, sources[i]))
+			return false;
+
+		ENSURE(has_more_fix_nodes(g) == (i + 1 < num_ids), "Invalid number of nodes in group 457");
+	}
+
+	return true;
+}
+
+bool valid_nested_groups_message(fix_group* const group)
+{
+	bool ret = valid_char(group, 		49,		'A')
+			&& valid_char(group, 		56,		'B')
+			&& valid_long(group,		34,		12);
+
+	if(!ret)
+		return false;
+
+	fix_group *g = NULL, *u = NULL;
+	fix_error err = get_fix_tag_as_group(group, 268, &g);
+
+	ENSURE(err == FE_OK && get_fix_group_size(g) == 2, "Invalid group 268 (error %d)", (int)err);
+
+	// first entry: two underlyings with 2 and 1 alternative IDs
+	err = get_fix_tag_as_group(g, 711, &u);
+	ENSURE(err == FE_OK && get_fix_group_size(u) == 2, "Invalid group 711 (error %d)", (int)err);
+
+	ret =  valid_long(g,	269,	0)
+		&& valid_double(g,	270,	1.37215)
+		&& valid_long(g,	271,	2500000)
+		&& valid_underlying(u, "EUR", 2, (const char*[]){ "EU1", "EU2" }, (const long[]){ 4, 8 })
+		&& has_more_fix_nodes(u)
+		&& valid_underlying(u, "USD", 1, (const char*[]){ "US1" }, (const long[]){ 4 })
+		&& !has_more_fix_nodes(u);
+
+	if(!ret)
+		return false;
+
+	// second entry: one underlying
+	ENSURE(has_more_fix_nodes(g), "Failed to scroll to the next group node");
+
+	err = get_fix_tag_as_group(g, 711, &u);
+	ENSURE(err == FE_OK && get_fix_group_size(u) == 1, "Invalid group 711 (error %d)", (int)err);
+
+	ret =  valid_long(g,	269,	1)
+		&& valid_double(g,	270,	1.37224)
+		&& valid_long(g,	271,	2503200)
+		&& valid_underlying(u, "EUR", 1, (const char*[]){ "EU1" }, (const long[]){ 4 });
+
+	if(!ret)
+		return false;
+
+	ENSURE(!has_more_fix_nodes(g), "Unexpected next group node");
+	return true;
+}
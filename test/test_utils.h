@@ -91,11 +91,12 @@ bool parse_input_once(fix_parser* const parser, const fix_string input, message_
 // test messages -----------------------------------------------------------------------------
 extern const fix_string simple_message, bad_message_1, bad_message_2, simple_message_bin,
 						message_with_groups, message_with_groups_4_4, bad_message_with_groups_4_4,
-						bad_message_with_groups;
+						bad_message_with_groups, nested_groups_message;
 
 // parser table for simple message
 const fix_message_info* simple_message_parser_table(const fix_string type);
 const fix_message_info* missing_tag_parser_table(const fix_string type);
+const fix_message_info* tag_table_parser_table(const fix_string type);
 
 // parser table for message with groups
 const fix_message_info* message_with_groups_parser_table(const fix_string type);
@@ -103,3 +104,4 @@ const fix_message_info* message_with_groups_parser_table(const fix_string type);
 // message validators ------------------------------------------------------------------------
 bool valid_simple_message(fix_group* const group);
 bool valid_message_with_groups(fix_group* const group);
+bool valid_nested_groups_message(fix_group* const group);
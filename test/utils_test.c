@@ -29,6 +29,7 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define _GNU_SOURCE
 
 #include "test_utils.h"
+#include <stdlib.h>
 #include <time.h>
 #include <string.h>
 
@@ -64,11 +65,62 @@ bool test_utc_timestamp_to_timeval()
 	PASSED;
 }
 
+// the converters of the values not followed by SOH; each value is copied to a buffer of its exact size
+static
+fix_string copy_unterminated(const char* const str)
+{
+	const size_t n = strlen(str);
+	char* const p = check_ptr(malloc(n));
+
+	memcpy(p, str, n);
+	return (fix_string){ p, p + n };
+}
+
+#define CONVERT(str, convert, result)	\
+	({ const fix_string v_ = copy_unterminated(str); const fix_error e_ = convert(v_, (result)); free((void*)v_.begin); e_; })
+
+static
+bool test_unterminated_values()
+{
+	utc_timestamp date, ts;
+	tz_timestamp tz;
+	fix_version ver;
+
+	ENSURE(CONVERT("2003-09-10", convert_fix_value_to_LocalMktDate, &date) == FE_OK
+		   && date.year == 2003 && date.month == 9 && date.day == 10, "Invalid LocalMktDate");
+	ENSURE(CONVERT("2003-09-1", convert_fix_value_to_LocalMktDate, &date) == FE_INCORRECT_VALUE_FORMAT, "Short LocalMktDate accepted");
+	ENSURE(CONVERT("2003-09-100", convert_fix_value_to_LocalMktDate, &date) == FE_INCORRECT_VALUE_FORMAT, "Long LocalMktDate accepted");
+
+	ENSURE(CONVERT("FIX44", convert_fix_value_to_fix_version, &ver) == FE_OK && ver == FIX44, "Invalid FIX version");
+	ENSURE(CONVERT("FIX50SP2", convert_fix_value_to_fix_version, &ver) == FE_OK && ver == FIX50SP2, "Invalid FIX version");
+	ENSURE(CONVERT("FIX50SP3", convert_fix_value_to_fix_version, &ver) == FE_INCORRECT_VALUE_FORMAT, "Invalid FIX version accepted");
+
+	ENSURE(CONVERT("20100225-19:41:57", convert_fix_value_to_utc_timestamp, &ts) == FE_OK
+		   && ts.second == 57 && ts.millisecond == 0, "Invalid timestamp");
+	ENSURE(CONVERT("20100225-19:41:57.316", convert_fix_value_to_utc_timestamp, &ts) == FE_OK
+		   && ts.millisecond == 316, "Invalid timestamp with milliseconds");
+	ENSURE(CONVERT("20100225-19:41:57.31", convert_fix_value_to_utc_timestamp, &ts) == FE_INCORRECT_VALUE_FORMAT,
+		   "Invalid timestamp accepted");
+	ENSURE(CONVERT("20100225-19:41", convert_fix_value_to_utc_timestamp, &ts) == FE_INCORRECT_VALUE_FORMAT,
+		   "Short timestamp accepted");
+
+	ENSURE(CONVERT("20100225-19:41:57", convert_fix_value_to_tz_timestamp, &tz) == FE_OK && tz.offset_minutes == 0,
+		   "Invalid tz timestamp");
+	ENSURE(CONVERT("20100225-19:41:57Z", convert_fix_value_to_tz_timestamp, &tz) == FE_OK && tz.offset_minutes == 0,
+		   "Invalid tz timestamp");
+	ENSURE(CONVERT("20100225-19:41:57-05:30", convert_fix_value_to_tz_timestamp, &tz) == FE_OK && tz.offset_minutes == -330,
+		   "Invalid tz timestamp with offset");
+	ENSURE(CONVERT("20100225-19:41:57+05", convert_fix_value_to_tz_timestamp, &tz) == FE_INCORRECT_VALUE_FORMAT,
+		   "Short tz offset accepted");
+	PASSED;
+}
+
 // all tests
 void utils_test()
 {
 	puts("# Utils tests:");
 
 	test_utc_timestamp_to_timeval();
+	test_unterminated_values();
 }
 
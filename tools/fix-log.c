@@ -0,0 +1,153 @@
+/*
+Copyright (c) 2015, Maxim Konakov
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// fix-log: parses FIX.4.4 log files on all cores, and reports the number of messages and the throughput
+
+#define _GNU_SOURCE
+
+#include "fix.h"
+#include "FIX44.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+// message counters
+typedef struct
+{
+	atomic_ulong num_messages, num_errors;
+	bool print_errors;
+} log_counters;
+
+static
+void count_message(const fix_parser_result* const res, void* ctx)
+{
+	log_counters* const counters = ctx;
+
+	atomic_fetch_add_explicit(&counters->num_messages, 1, memory_order_relaxed);
+
+	if(res->error.code != FE_OK)
+	{
+		atomic_fetch_add_explicit(&counters->num_errors, 1, memory_order_relaxed);
+
+		if(counters->print_errors)
+		{
+			const char* const msg = compose_fix_error_message(&res->error);
+
+			if(msg)
+			{
+				fprintf(stderr, "%s\n", msg);
+				free((void*)msg);
+			}
+		}
+	}
+}
+
+static
+void usage(const char* const name)
+{
+	fprintf(stderr, "Usage: %s [-t threads] [-c chunk-KB] [-o] [-e] file...\n"
+					"  -t  number of threads (default: all cores)\n"
+					"  -c  chunk size in kilobytes (default: 256)\n"
+					"  -o  deliver the messages in the file order\n"
+					"  -e  print the message errors\n", name);
+	exit(2);
+}
+
+int main(int argc, char** argv)
+{
+	fix_log_options options = { 0, 0, 0, false };
+	bool print_errors = false;
+	int opt;
+
+	while((opt = getopt(argc, argv, "t:c:oe")) != -1)
+	{
+		switch(opt)
+		{
+			case 't':	options.num_threads = strtoul(optarg, NULL, 10); break;
+			case 'c':	options.chunk_size = strtoul(optarg, NULL, 10) << 10; break;
+			case 'o':	options.ordered = true; break;
+			case 'e':	print_errors = true; break;
+			default:	usage(argv[0]);
+		}
+	}
+
+	if(optind >= argc)
+		usage(argv[0]);
+
+	fix_parser_spec* const spec = create_FIX44_parser_spec();
+
+	if(!spec)
+	{
+		fprintf(stderr, "Cannot create parser specification: %s\n", strerror(errno));
+		return 1;
+	}
+
+	int ret = 0;
+
+	for(int i = optind; i < argc; ++i)
+	{
+		const char* const file_name = argv[i];
+		struct stat st;
+
+		if(stat(file_name, &st) != 0)
+		{
+			fprintf(stderr, "%s: %s\n", file_name, strerror(errno));
+			ret = 1;
+			continue;
+		}
+
+		log_counters counters = { 0, 0, print_errors };
+		struct timespec start, stop;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
+		const fix_error err = parse_fix_log_file(spec, file_name, &options, count_message, &counters);
+
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+
+		const double t = (stop.tv_sec + stop.tv_nsec * 1e-9) - (start.tv_sec + start.tv_nsec * 1e-9);
+
+		printf("%s: %lu messages, %lu with errors, %lld bytes in %.3f s (%.2f GB/s)\n",
+			   file_name, (unsigned long)counters.num_messages, (unsigned long)counters.num_errors,
+			   (long long)st.st_size, t, st.st_size / t * 1e-9);
+
+		if(err != FE_OK)
+		{
+			fprintf(stderr, "%s: %s\n", file_name, err == FE_OTHER ? strerror(errno) : fix_error_to_string(err));
+			ret = 1;
+		}
+	}
+
+	free_fix_parser_spec(spec);
+	return ret;
+}